@@ -4,10 +4,13 @@
 in vec2 texCoord;
 out vec4 fragColor;
 
-uniform sampler2D tex;
+struct Material {
+    sampler2D diffuse;
+};
+uniform Material material;
 
 void main() {
-    vec4 pixel = texture(tex, texCoord);
+    vec4 pixel = texture(material.diffuse, texCoord);
     if (pixel.a < 0.05)
         discard;
     fragColor = pixel;
@@ -0,0 +1,5 @@
+#version 330 core
+
+// depth만 기록하므로 색상 출력 없음
+void main() {
+}
\ No newline at end of file
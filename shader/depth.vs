@@ -0,0 +1,11 @@
+#version 330 core
+
+// shadow pass 전용, 위치만 읽음
+layout (location = 0) in vec3 aPos;
+layout (location = 4) in mat4 aModel;
+
+uniform mat4 viewProjection;
+
+void main() {
+    gl_Position = viewProjection * aModel * vec4(aPos, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#version 330 core
+
+in vec2 texCoord;
+
+struct Material {
+    sampler2D diffuse;
+};
+uniform Material material;
+
+// 잎 모양대로 그림자가 생기도록 alpha만 검사
+void main() {
+    if (texture(material.diffuse, texCoord).a < 0.05)
+        discard;
+}
\ No newline at end of file
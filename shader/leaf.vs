@@ -2,11 +2,12 @@
 
 layout (location = 0) in vec3 aPos;
 layout (location = 2) in vec2 aTexCoord;
+layout (location = 4) in mat4 aModel;
 out vec2 texCoord;
 
-uniform mat4 transform;
+uniform mat4 viewProjection;
 
 void main() {
-    gl_Position = transform * vec4(aPos, 1.0);
+    gl_Position = viewProjection * aModel * vec4(aPos, 1.0);
     texCoord = aTexCoord;
 }
\ No newline at end of file
@@ -29,32 +29,88 @@ struct Material {
 };
 uniform Material material;
 uniform int blinn;
-uniform sampler2D shadowMap;
+// depth compare가 켜진 shadow map: texture()가 비교 결과를 bilinear로 섞은 값(빛을 받는 비율)을 돌려줌
+uniform sampler2DShadow shadowMap;
+
+// cascade shadow map (cascadeCount가 0이면 shadowMap 한 장만 사용)
+uniform int cascadeCount;
+uniform float cascadeSplits[4];
+uniform mat4 cascadeTransforms[4];
+uniform vec3 viewDir;
+uniform sampler2DArrayShadow shadowMapArray;
+
+// PCF 품질: sample 개수(1 ~ 16)와 texel 단위 필터 반경
+uniform int shadowSamples;
+uniform float shadowFilterRadius;
+
+const vec2 poissonDisk[16] = vec2[](
+    vec2(-0.94201624, -0.39906216), vec2(0.94558609, -0.76890725),
+    vec2(-0.09418410, -0.92938870), vec2(0.34495938, 0.29387760),
+    vec2(-0.91588581, 0.45771432), vec2(-0.81544232, -0.87912464),
+    vec2(-0.38277543, 0.27676845), vec2(0.97484398, 0.75648379),
+    vec2(0.44323325, -0.97511554), vec2(0.53742981, -0.47373420),
+    vec2(-0.26496911, -0.41893023), vec2(0.79197514, 0.19090188),
+    vec2(-0.24188840, 0.99706507), vec2(-0.81409955, 0.91437590),
+    vec2(0.19984126, 0.78641367), vec2(0.14383161, -0.14100790)
+);
+
+// 픽셀마다 kernel을 돌려서 적은 sample로도 줄무늬 대신 잔 노이즈가 되게 함
+mat2 PoissonRotation() {
+    float noise = fract(52.9829189 * fract(dot(gl_FragCoord.xy, vec2(0.06711056, 0.00583715))));
+    float angle = noise * 6.28318531;
+    float s = sin(angle);
+    float c = cos(angle);
+    return mat2(c, s, -s, c);
+}
+
+float ShadowBias(vec3 normal, vec3 lightDir) {
+    return max(0.02 * (1.0 - dot(normal, lightDir)), 0.001);
+}
 
 float ShadowCalculation(vec4 fragPosLight, vec3 normal, vec3 lightDir) {
     // perform perspective divide
     vec3 projCoords = fragPosLight.xyz / fragPosLight.w;
     // transform to [0,1] range
     projCoords = projCoords * 0.5 + 0.5;
-    // get closest depth value from light’s perspective (using
-    // [0,1] range fragPosLight as coords)
-    float closestDepth = texture(shadowMap, projCoords.xy).r;
-    // get depth of current fragment from light’s perspective
-    float currentDepth = projCoords.z;
-    // check whether current frag pos is in shadow
-    float bias = max(0.02 * (1.0 - dot(normal, lightDir)), 0.001);
-    float shadow = 0.0;
-    vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
-    for(int x = -1; x <= 1; ++x) {
-        for (int y = -1; y <= 1; ++y) {
-            float pcfDepth = texture(shadowMap,
-                projCoords.xy + vec2(x, y) * texelSize).r;
-            shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
+    if (projCoords.z > 1.0)
+        return 0.0;
+
+    float reference = projCoords.z - ShadowBias(normal, lightDir);
+    vec2 filterSize = shadowFilterRadius / vec2(textureSize(shadowMap, 0));
+    mat2 rotation = PoissonRotation();
+    float lit = 0.0;
+    for (int i = 0; i < shadowSamples; ++i) {
+        vec2 offset = rotation * poissonDisk[i] * filterSize;
+        lit += texture(shadowMap, vec3(projCoords.xy + offset, reference));
+    }
+    return 1.0 - lit / float(shadowSamples);
+}
+
+float CascadeShadowCalculation(vec3 fragPos, vec3 normal, vec3 lightDir) {
+    // 카메라 시선 방향 거리로 cascade 선택
+    float depth = dot(fragPos - viewPos, viewDir);
+    int layer = cascadeCount - 1;
+    for (int i = 0; i < cascadeCount; ++i) {
+        if (depth < cascadeSplits[i]) {
+            layer = i;
+            break;
         }
     }
-    shadow /= 9.0;
+    vec4 fragPosLight = cascadeTransforms[layer] * vec4(fragPos, 1.0);
+    vec3 projCoords = fragPosLight.xyz / fragPosLight.w;
+    projCoords = projCoords * 0.5 + 0.5;
+    if (projCoords.z > 1.0)
+        return 0.0;
 
-    return shadow;
+    float reference = projCoords.z - ShadowBias(normal, lightDir);
+    vec2 filterSize = shadowFilterRadius / vec2(textureSize(shadowMapArray, 0).xy);
+    mat2 rotation = PoissonRotation();
+    float lit = 0.0;
+    for (int i = 0; i < shadowSamples; ++i) {
+        vec2 offset = rotation * poissonDisk[i] * filterSize;
+        lit += texture(shadowMapArray, vec4(projCoords.xy + offset, float(layer), reference));
+    }
+    return 1.0 - lit / float(shadowSamples);
 }
 
 void main() {
@@ -96,7 +152,9 @@ void main() {
             spec = pow(max(dot(halfDir, pixelNorm), 0.0), material.shininess);
         }
         vec3 specular = spec * specColor * light.specular;
-        float shadow = ShadowCalculation(fs_in.fragPosLight, pixelNorm, lightDir);
+        float shadow = cascadeCount > 0 ?
+            CascadeShadowCalculation(fs_in.fragPos, pixelNorm, lightDir) :
+            ShadowCalculation(fs_in.fragPosLight, pixelNorm, lightDir);
 
         result += (diffuse + specular) * intensity * (1.0 - shadow);
     }
@@ -3,6 +3,7 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
+layout (location = 4) in mat4 aModel;
 
 out VS_OUT {
     vec3 fragPos;
@@ -11,14 +12,14 @@ out VS_OUT {
     vec4 fragPosLight;
 } vs_out;
 
-uniform mat4 transform;
-uniform mat4 modelTransform;
+uniform mat4 viewProjection;
 uniform mat4 lightTransform;
 
 void main() {
-    gl_Position = transform * vec4(aPos, 1.0);
-    vs_out.fragPos = vec3(modelTransform * vec4(aPos, 1.0));
-    vs_out.normal = transpose(inverse(mat3(modelTransform))) * aNormal;
+    vec4 worldPos = aModel * vec4(aPos, 1.0);
+    gl_Position = viewProjection * worldPos;
+    vs_out.fragPos = worldPos.xyz;
+    vs_out.normal = transpose(inverse(mat3(aModel))) * aNormal;
     vs_out.texCoord = aTexCoord;
     vs_out.fragPosLight = lightTransform * vec4(vs_out.fragPos, 1.0);
 }
\ No newline at end of file
@@ -1,8 +1,9 @@
 #version 330 core
 layout (location = 0) in vec3 aPos; // 0번째 attribute가 정점의 위치
+layout (location = 4) in mat4 aModel; // instance 별 model 행렬
 
-uniform mat4 transform;
+uniform mat4 viewProjection;
 
 void main() {
-	gl_Position = transform * vec4(aPos, 1.0); // vec3를 vec4 생성자에 사용
+	gl_Position = viewProjection * aModel * vec4(aPos, 1.0); // vec3를 vec4 생성자에 사용
 }
\ No newline at end of file
@@ -1,10 +1,12 @@
 #include "context.h"
+#include "tree_stream.h"
 
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 #include <spdlog/spdlog.h>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <chrono>
 
 // matX, X = 2, 3, 4
 // vecX, X = 2, 3, 4
@@ -65,8 +67,66 @@ void OnWindowIconify(GLFWwindow* window, int iconified) {
     }
 }
 
+// --stream-export <out.obj>: 창 없이 나무를 streaming으로 obj에 쓰고 종료
+// --axiom, --rule (여러 번), --iteration, --angle, --seed, --sphere, --memory-mb로 나무와 메모리 예산을 정함
+// 나머지 값과 rule을 주지 않았을 때의 값은 프로그램의 기본 나무와 같음
+int RunStreamExport(int argc, const char** argv) {
+	TreeStream::Options options;
+	options.params = { 0.1f, 1.0f, 0.2f, 0.2f, 0.75f, 0.75f, 30.0f, 3, 0, 0, 0.0f, 0.0f };
+	options.axiom = "FFA";
+	std::string path;
+	std::string rules;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--stream-export" && hasValue)
+			path = argv[++i];
+		else if (arg == "--axiom" && hasValue)
+			options.axiom = argv[++i];
+		else if (arg == "--rule" && hasValue)
+			rules += std::string(argv[++i]) + "\n";
+		else if (arg == "--iteration" && hasValue)
+			options.params.iteration = std::atoi(argv[++i]);
+		else if (arg == "--angle" && hasValue)
+			options.params.angle = (float)std::atof(argv[++i]);
+		else if (arg == "--seed" && hasValue)
+			options.params.seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+		else if (arg == "--sphere")
+			options.params.sphere = 1;
+		else if (arg == "--memory-mb" && hasValue)
+			options.memoryBudget = (size_t)std::strtoull(argv[++i], nullptr, 10) << 20;
+	}
+	if (path.empty()) {
+		SPDLOG_ERROR("usage: --stream-export <out.obj> [--axiom A] [--rule X=...] [--iteration N] [--angle D] [--seed S] [--sphere] [--memory-mb M]");
+		return -1;
+	}
+	options.rules = rules.empty() ?
+		"A=F[--&&&FC][++&&&FC][--^FC][++^FC]\nC=F[--<&&FC]||[++>&&FC]||[+<^^FC]||[->^^FC]" : rules;
+
+	auto startTime = std::chrono::steady_clock::now();
+	auto pool = ThreadPool::Create();
+	if (!TreeStream::ExportObj(options, path, pool.get()))
+		return -1;
+	auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	SPDLOG_INFO("stream export finished in {:.2f} s", elapsed);
+	return 0;
+}
+
 int main(int argc, const char** argv){
     SPDLOG_INFO("Start Program");
+	auto startTime = std::chrono::steady_clock::now();
+
+	// --no-program-cache: program binary cache 없이 매번 compile (시작 시간 비교용)
+	// --no-mesh-cache: 모델을 열 때마다 원본 파일을 다시 parse
+	// --stream-export: 창을 만들지 않고 나무를 파일로 내보낸 뒤 종료 (RunStreamExport 참고)
+	for (int i = 1; i < argc; i++) {
+		if (std::string(argv[i]) == "--no-program-cache")
+			Program::SetBinaryCacheEnabled(false);
+		else if (std::string(argv[i]) == "--no-mesh-cache")
+			MeshCache::SetEnabled(false);
+		else if (std::string(argv[i]) == "--stream-export")
+			return RunStreamExport(argc, argv);
+	}
 
 	// glfw 라이브러리 초기화, 실패하면 에러 출력 후 종료
 	SPDLOG_INFO("Initialize glfw");
@@ -133,6 +193,7 @@ int main(int argc, const char** argv){
 
 	// glfw 루프 실행, 윈도우 close 버튼을 누르면 정상 종료
 	SPDLOG_INFO("Start main loop");
+	bool firstFrame = true;
 	while (!glfwWindowShouldClose(window)) {
 		// loop에서 이벤트를 수집
 		// 이벤트가 발생했을 때 호출을 무엇을 할지 콜백 함수를 통해 정의
@@ -146,6 +207,15 @@ int main(int argc, const char** argv){
 		ImGui::Render();
 		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 		glfwSwapBuffers(window);
+
+		if (firstFrame) {
+			firstFrame = false;
+			auto elapsed = std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - startTime).count();
+			const auto& cacheStats = Program::GetBinaryCacheStats();
+			SPDLOG_INFO("time to first frame: {:.1f} ms (program cache hits: {}, misses: {})",
+				elapsed, cacheStats.hits, cacheStats.misses);
+		}
 	}
 	// main loop 종료
 	context.reset();
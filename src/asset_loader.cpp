@@ -0,0 +1,115 @@
+#include "asset_loader.h"
+
+AssetLoaderUPtr AssetLoader::Create(size_t threadCount) {
+    auto loader = AssetLoaderUPtr(new AssetLoader());
+    if (!loader->Init(threadCount))
+        return nullptr;
+    return std::move(loader);
+}
+
+bool AssetLoader::Init(size_t threadCount) {
+    m_threadPool = ThreadPool::Create(threadCount);
+    if (!m_threadPool)
+        return false;
+    m_uploader = PixelUploader::Create(m_threadPool.get());
+    return m_uploader ? true : false;
+}
+
+void AssetLoader::LoadImages(const std::vector<std::string>& paths, bool flipVertical,
+    ImagesCallback callback) {
+    auto job = std::make_shared<Job>();
+    job->images.resize(paths.size());
+    job->remaining = paths.size();
+    job->callback = std::move(callback);
+    m_pending++;
+
+    if (paths.empty()) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_finished.push_back(job);
+        return;
+    }
+
+    // 이미지 한 장이 작업 하나, 마지막으로 끝난 worker가 완료 목록에 넣음
+    for (size_t i = 0; i < paths.size(); i++) {
+        m_threadPool->Enqueue([this, job, i, path = paths[i], flipVertical]() {
+            job->images[i] = Image::Load(path, flipVertical);
+            if (--job->remaining == 0) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_finished.push_back(job);
+            }
+        });
+    }
+}
+
+TexturePtr AssetLoader::LoadTexture(const std::string& path, bool flipVertical) {
+    TexturePtr texture = Texture::CreateFromImage(
+        Image::CreateSingleColorImage(4, 4, glm::vec4(0.5f, 0.5f, 0.5f, 1.0f)).get());
+    TextureWPtr target = texture;
+    LoadImages({ path }, flipVertical, [this, target](std::vector<ImageUPtr>& images) {
+        if (!images[0] || target.expired())
+            return;
+        ImagePtr image = std::move(images[0]);
+        m_uploader->Upload({ image }, [target, image](const std::vector<size_t>& offsets) {
+            auto texture = target.lock();
+            if (texture) {
+                texture->SetImageFromPixelBuffer(image->GetWidth(), image->GetHeight(),
+                    image->GetChannelCount(), (const void*)offsets[0]);
+            }
+        });
+    });
+    return texture;
+}
+
+void AssetLoader::LoadCubeTexture(const std::vector<std::string>& paths,
+    std::function<void(CubeTexturePtr texture)> callback) {
+    LoadImages(paths, false, [this, callback](std::vector<ImageUPtr>& images) {
+        if (images.size() != 6) {
+            SPDLOG_ERROR("cube texture needs 6 faces, got {}", images.size());
+            return;
+        }
+        if (!images[0]) {
+            SPDLOG_ERROR("failed to load cube texture face 0");
+            return;
+        }
+        // 첫 face는 loop 안에서 move되므로 크기를 먼저 꺼내 둠
+        int width = images[0]->GetWidth();
+        int height = images[0]->GetHeight();
+        std::vector<ImagePtr> faces;
+        for (size_t i = 0; i < images.size(); i++) {
+            auto& image = images[i];
+            if (!image) {
+                SPDLOG_ERROR("failed to load cube texture face {}", i);
+                return;
+            }
+            if (image->GetWidth() != width || image->GetHeight() != height) {
+                SPDLOG_ERROR("cube texture faces must have the same size");
+                return;
+            }
+            faces.push_back(std::move(image));
+        }
+
+        // 저장 공간은 PBO가 bind되기 전에 할당
+        CubeTexturePtr cubeTexture = CubeTexture::Create(faces[0]->GetWidth(), faces[0]->GetHeight());
+        m_uploader->Upload(faces, [callback, cubeTexture, faces](const std::vector<size_t>& offsets) {
+            for (int i = 0; i < (int)faces.size(); i++) {
+                cubeTexture->SetFaceFromPixelBuffer(i, faces[i]->GetWidth(), faces[i]->GetHeight(),
+                    faces[i]->GetChannelCount(), (const void*)offsets[i]);
+            }
+            callback(cubeTexture);
+        });
+    });
+}
+
+void AssetLoader::Update() {
+    std::vector<std::shared_ptr<Job>> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        finished.swap(m_finished);
+    }
+    for (auto& job : finished) {
+        if (job->callback)
+            job->callback(job->images);
+        m_pending--;
+    }
+    m_uploader->Update();
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef __ASSET_LOADER_H__
+#define __ASSET_LOADER_H__
+
+#include "common.h"
+#include "image.h"
+#include "texture.h"
+#include "thread_pool.h"
+#include "pixel_uploader.h"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+/*
+이미지 decode는 worker thread에서 동시에 하고 GL upload는 main thread의 Update에서 처리
+GL 함수는 context를 가진 main thread에서만 호출할 수 있으므로 callback도 Update 안에서만 실행됨
+texture는 PixelUploader의 PBO를 거쳐서 올리므로 render thread에서 큰 복사가 일어나지 않음
+*/
+CLASS_PTR(AssetLoader)
+class AssetLoader {
+public:
+    // decode에 실패한 이미지는 nullptr
+    using ImagesCallback = std::function<void(std::vector<ImageUPtr>& images)>;
+
+    static AssetLoaderUPtr Create(size_t threadCount = 0);
+
+    // paths의 이미지를 모두 decode한 뒤 한 번에 callback 호출
+    void LoadImages(const std::vector<std::string>& paths, bool flipVertical, ImagesCallback callback);
+    // 회색 placeholder를 바로 돌려주고 decode가 끝나면 같은 texture에 이미지를 올림
+    TexturePtr LoadTexture(const std::string& path, bool flipVertical = true);
+    // 6면(right, left, top, bottom, front, back)을 모두 올린 뒤 callback 호출
+    void LoadCubeTexture(const std::vector<std::string>& paths,
+        std::function<void(CubeTexturePtr texture)> callback);
+
+    // 매 프레임 main thread에서 호출, 끝난 작업의 callback 실행
+    void Update();
+    size_t GetPendingCount() const { return m_pending + m_uploader->GetPendingCount(); }
+    // 다른 CPU 작업(모델 parse 등)도 같은 worker를 나눠 씀
+    ThreadPool* GetThreadPool() const { return m_threadPool.get(); }
+
+private:
+    AssetLoader() {}
+    bool Init(size_t threadCount);
+
+    struct Job {
+        std::vector<ImageUPtr> images;
+        std::atomic<size_t> remaining { 0 };
+        ImagesCallback callback;
+    };
+
+    std::mutex m_mutex;
+    std::vector<std::shared_ptr<Job>> m_finished;
+    size_t m_pending { 0 }; // main thread에서만 접근
+    PixelUploaderUPtr m_uploader;
+
+    // 가장 먼저 소멸되어야 worker가 Job, map된 PBO에 접근하는 동안 다른 멤버가 살아있음
+    ThreadPoolUPtr m_threadPool;
+};
+
+#endif // __ASSET_LOADER_H__
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef __BOUNDED_QUEUE_H__
+#define __BOUNDED_QUEUE_H__
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+/*
+pipeline 단계 사이를 잇는 크기가 정해진 queue
+가득 차면 Push가, 비어 있으면 Pop이 기다리므로 앞 단계가 뒤 단계보다 capacity 이상 앞서가지 않음
+Close 이후 Push는 버려지고 Pop은 남은 항목을 다 꺼낸 뒤 false
+*/
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : m_capacity(capacity > 0 ? capacity : 1) {}
+
+    // 닫혀 있으면 false
+    bool Push(T item) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this]() { return m_closed || m_items.size() < m_capacity; });
+        if (m_closed)
+            return false;
+        m_items.push_back(std::move(item));
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    // 닫혀 있고 비어 있으면 false
+    bool Pop(T& item) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this]() { return m_closed || !m_items.empty(); });
+        if (m_items.empty())
+            return false;
+        item = std::move(m_items.front());
+        m_items.pop_front();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    void Close() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_notFull.notify_all();
+        m_notEmpty.notify_all();
+    }
+
+private:
+    size_t m_capacity;
+    std::deque<T> m_items;
+    bool m_closed { false };
+    std::mutex m_mutex;
+    std::condition_variable m_notFull;
+    std::condition_variable m_notEmpty;
+};
+
+#endif // __BOUNDED_QUEUE_H__
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "bounds.h"
+
+void AABB::Expand(const glm::vec3& point) {
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+}
+
+void AABB::Expand(const AABB& other) {
+    if (!other.IsValid())
+        return;
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+}
+
+// 중심과 반지름을 변환하는 방식 (Arvo), 꼭짓점 8개를 모두 변환하는 것보다 빠름
+AABB AABB::Transform(const glm::mat4& matrix) const {
+    if (!IsValid())
+        return AABB();
+
+    glm::vec3 center = GetCenter();
+    glm::vec3 extent = GetExtent();
+    glm::vec3 newCenter = glm::vec3(matrix * glm::vec4(center, 1.0f));
+    glm::vec3 newExtent = glm::vec3(0.0f);
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++)
+            newExtent[i] += glm::abs(matrix[j][i]) * extent[j];
+    }
+
+    AABB result;
+    result.min = newCenter - newExtent;
+    result.max = newCenter + newExtent;
+    return result;
+}
+
+// Gribb & Hartmann, clip space z 범위는 OpenGL 기준 [-w, w]
+Frustum Frustum::FromMatrix(const glm::mat4& viewProjection) {
+    auto row = [&viewProjection](int i) -> glm::vec4 {
+        return glm::vec4(viewProjection[0][i], viewProjection[1][i],
+            viewProjection[2][i], viewProjection[3][i]);
+    };
+
+    Frustum frustum;
+    frustum.planes[0] = row(3) + row(0); // left
+    frustum.planes[1] = row(3) - row(0); // right
+    frustum.planes[2] = row(3) + row(1); // bottom
+    frustum.planes[3] = row(3) - row(1); // top
+    frustum.planes[4] = row(3) + row(2); // near
+    frustum.planes[5] = row(3) - row(2); // far
+
+    for (auto& plane : frustum.planes) {
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f)
+            plane /= length;
+    }
+    return frustum;
+}
+
+Frustum::Result Frustum::Test(const AABB& box) const {
+    if (!box.IsValid())
+        return OUTSIDE;
+
+    Result result = INSIDE;
+    for (const auto& plane : planes) {
+        // 평면 법선 방향으로 가장 먼 꼭짓점(p)과 가장 가까운 꼭짓점(n)
+        glm::vec3 p = glm::vec3(
+            plane.x >= 0.0f ? box.max.x : box.min.x,
+            plane.y >= 0.0f ? box.max.y : box.min.y,
+            plane.z >= 0.0f ? box.max.z : box.min.z);
+        glm::vec3 n = glm::vec3(
+            plane.x >= 0.0f ? box.min.x : box.max.x,
+            plane.y >= 0.0f ? box.min.y : box.max.y,
+            plane.z >= 0.0f ? box.min.z : box.max.z);
+
+        if (glm::dot(glm::vec3(plane), p) + plane.w < 0.0f)
+            return OUTSIDE;
+        if (glm::dot(glm::vec3(plane), n) + plane.w < 0.0f)
+            result = INTERSECT;
+    }
+    return result;
+}
@@ -0,0 +1,36 @@
+#ifndef __BOUNDS_H__
+#define __BOUNDS_H__
+
+#include "common.h"
+#include <limits>
+
+// axis aligned bounding box, 비어있는 상태는 min > max
+struct AABB {
+    glm::vec3 min { std::numeric_limits<float>::max() };
+    glm::vec3 max { -std::numeric_limits<float>::max() };
+
+    bool IsValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+    glm::vec3 GetCenter() const { return (min + max) * 0.5f; }
+    glm::vec3 GetExtent() const { return (max - min) * 0.5f; }
+
+    void Expand(const glm::vec3& point);
+    void Expand(const AABB& other);
+    // 변환된 8개 꼭짓점을 감싸는 AABB
+    AABB Transform(const glm::mat4& matrix) const;
+};
+
+// view-projection 행렬에서 뽑아낸 6개의 평면 (법선이 안쪽을 향함)
+struct Frustum {
+    enum Result {
+        OUTSIDE,
+        INTERSECT,
+        INSIDE
+    };
+
+    static Frustum FromMatrix(const glm::mat4& viewProjection);
+    Result Test(const AABB& box) const;
+
+    glm::vec4 planes[6];
+};
+
+#endif // __BOUNDS_H__
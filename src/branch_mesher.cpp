@@ -0,0 +1,234 @@
+#include "branch_mesher.h"
+#include "turtle.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    struct Ring {
+        glm::vec3 center;
+        glm::vec3 axis;
+        float radius;
+        float slope;   // 축 방향으로 줄어드는 반지름의 기울기, 옆면 normal의 축 성분
+    };
+}
+
+std::vector<int32_t> BranchMesher::FindParents(const std::string& codes) {
+    // Turtle과 같이 '['에서 현재 가지를 저장하고 ']'에서 되돌림, 짝이 없는 ']'는 무시
+    std::vector<int32_t> parents;
+    std::vector<int32_t> saved;
+    int32_t current = -1;
+    for (char symbol : codes) {
+        if (Turtle::IsBranch(symbol)) {
+            parents.push_back(current);
+            current = (int32_t)parents.size() - 1;
+        }
+        else if (symbol == '[') {
+            saved.push_back(current);
+        }
+        else if (symbol == ']' && !saved.empty()) {
+            current = saved.back();
+            saved.pop_back();
+        }
+    }
+    return parents;
+}
+
+bool BranchMesher::Build(const Params& params, const std::vector<glm::mat4>& instances,
+    const std::vector<int32_t>& parents, ThreadPool* pool,
+    std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    vertices.clear();
+    indices.clear();
+    if (instances.size() != parents.size() || params.slices < 3 || params.minSlices < 3) {
+        SPDLOG_ERROR("Invalid branch skeleton : {} instances, {} parents", instances.size(), parents.size());
+        return false;
+    }
+
+    // 마지막 자식이 부모를 잇는 가지, '[' 안의 곁가지 뒤에 오는 원줄기가 보통 여기에 해당
+    size_t count = instances.size();
+    std::vector<int32_t> next(count, -1);
+    for (size_t i = 0; i < count; i++) {
+        if (parents[i] >= 0)
+            next[parents[i]] = (int32_t)i;
+    }
+    // 가지마다 원기둥 mesh의 아래, 위 원을 world로 옮긴 것
+    auto SegmentRing = [&](int32_t segment, bool top) {
+        const auto& matrix = instances[segment];
+        glm::vec3 bottomCenter = glm::vec3(matrix * glm::vec4(0.0f, -params.height / 2.0f, 0.0f, 1.0f));
+        glm::vec3 topCenter = glm::vec3(matrix * glm::vec4(0.0f, params.height / 2.0f, 0.0f, 1.0f));
+        // x, z 방향 scale의 평균으로 원의 반지름을 정함
+        float scale = (glm::length(glm::vec3(matrix[0])) + glm::length(glm::vec3(matrix[2]))) / 2.0f;
+        float length = glm::length(topCenter - bottomCenter);
+        Ring ring;
+        ring.center = top ? topCenter : bottomCenter;
+        ring.axis = (topCenter - bottomCenter) / length;
+        ring.radius = params.radius * (top ? params.rate : 1.0f) * scale;
+        // 원기둥 mesh의 옆면 normal과 같이 (아래 반지름 - 위 반지름) / 높이
+        ring.slope = params.radius * (1.0f - params.rate) * scale / length;
+        return ring;
+    };
+    // point가 가지 원기둥 안에 있는지, 반지름은 축을 따라 선형으로 줄어듦
+    auto InsideSegment = [&](int32_t segment, const glm::vec3& point) {
+        Ring bottom = SegmentRing(segment, false);
+        Ring top = SegmentRing(segment, true);
+        float length = glm::length(top.center - bottom.center);
+        float t = glm::clamp(glm::dot(point - bottom.center, bottom.axis) / length, 0.0f, 1.0f);
+        glm::vec3 onAxis = bottom.center + bottom.axis * (t * length);
+        return glm::length(point - onAxis) < bottom.radius + (top.radius - bottom.radius) * t;
+    };
+
+    struct Chain {
+        int32_t first;
+        uint32_t segments;
+        uint32_t slices;
+        bool baseCap;
+        size_t vertexOffset;
+        size_t indexOffset;
+    };
+    std::vector<Chain> chains;
+    for (size_t i = 0; i < count; i++) {
+        int32_t parent = parents[i];
+        if (parent >= 0 && next[parent] == (int32_t)i)
+            continue;
+        chains.push_back({ (int32_t)i, 0, 0, false, 0, 0 });
+    }
+
+    // chain마다 ring (segments + 1)개, 각 ring은 이음매 vertex 포함 slices + 1개
+    // 뚜껑은 중심 vertex 없이 둘레 slices개를 부채꼴로 이음 (삼각형 slices - 2개)
+    // 끝 뚜껑은 모든 chain에, 아래 뚜껑은 시작점이 부모 원기둥 밖으로 나온 곁가지에만 만듦
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    for (auto& chain : chains) {
+        for (int32_t i = chain.first; i >= 0; i = next[i])
+            chain.segments++;
+        // 원과 다각형의 최대 거리 r * (1 - cos(pi / n))가 굵기와 상관없이 같도록 분할 수를 반지름의 제곱근에 비례시킴
+        float ratio = SegmentRing(chain.first, false).radius / params.radius;
+        chain.slices = (uint32_t)std::clamp((int)std::ceil(params.slices * std::sqrt(ratio)),
+            std::min(params.minSlices, params.slices), params.slices);
+        int32_t parent = parents[chain.first];
+        if (parent >= 0) {
+            glm::vec3 start = SegmentRing(chain.first, false).center;
+            chain.baseCap = !InsideSegment(parent, start) && (next[parent] < 0 || !InsideSegment(next[parent], start));
+        }
+        chain.vertexOffset = vertexCount;
+        chain.indexOffset = indexCount;
+        size_t caps = chain.baseCap ? 2 : 1;
+        vertexCount += (size_t)(chain.segments + 1) * (chain.slices + 1) + caps * chain.slices;
+        indexCount += (size_t)chain.segments * chain.slices * 6 + caps * (chain.slices - 2) * 3;
+    }
+    if (vertexCount > UINT32_MAX) {
+        SPDLOG_ERROR("Too many branch vertices : {}", vertexCount);
+        return false;
+    }
+    vertices.resize(vertexCount);
+    indices.resize(indexCount);
+
+    auto MeshChain = [&](size_t chainIndex) {
+        const auto& chain = chains[chainIndex];
+        const uint32_t slices = chain.slices;
+        const uint32_t ringSize = slices + 1;
+        std::vector<glm::vec2> circle(ringSize);
+        for (uint32_t j = 0; j < ringSize; j++) {
+            float angle = glm::two_pi<float>() * (float)j / (float)slices;
+            circle[j] = glm::vec2(glm::cos(angle), glm::sin(angle));
+        }
+
+        // 가지 사이의 ring은 앞 가지의 위 원과 뒤 가지의 아래 원의 중간
+        std::vector<Ring> rings;
+        rings.reserve(chain.segments + 1);
+        int32_t previous = -1;
+        for (int32_t i = chain.first; i >= 0; i = next[i]) {
+            Ring bottom = SegmentRing(i, false);
+            if (previous >= 0) {
+                Ring top = SegmentRing(previous, true);
+                bottom.center = (top.center + bottom.center) / 2.0f;
+                bottom.radius = (top.radius + bottom.radius) / 2.0f;
+                bottom.slope = (top.slope + bottom.slope) / 2.0f;
+                glm::vec3 axis = top.axis + bottom.axis;
+                bottom.axis = glm::dot(axis, axis) > 1e-12f ? glm::normalize(axis) : bottom.axis;
+            }
+            rings.push_back(bottom);
+            previous = i;
+        }
+        rings.push_back(SegmentRing(previous, true));
+
+        // 첫 가지의 x축에서 시작해서 ring마다 축에 수직이 되도록 옮김 (parallel transport, 꼬임 없음)
+        glm::vec3 side = glm::vec3(instances[chain.first][0]);
+        Vertex* out = vertices.data() + chain.vertexOffset;
+        glm::vec3 u, v;
+        glm::vec3 baseU, baseV;
+        for (size_t k = 0; k < rings.size(); k++) {
+            const auto& ring = rings[k];
+            glm::vec3 projected = side - glm::dot(side, ring.axis) * ring.axis;
+            if (glm::dot(projected, projected) < 1e-12f) {
+                projected = glm::abs(ring.axis.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+                projected -= glm::dot(projected, ring.axis) * ring.axis;
+            }
+            u = glm::normalize(projected);
+            v = glm::cross(u, ring.axis);
+            side = u;
+            if (k == 0) {
+                baseU = u;
+                baseV = v;
+            }
+
+            float texV = (k % 2 == 0) ? Mesh::kCylinderSideBottomV : Mesh::kCylinderSideTopV;
+            for (uint32_t j = 0; j < ringSize; j++) {
+                glm::vec3 radial = circle[j].x * u + circle[j].y * v;
+                *out++ = Vertex{ ring.center + ring.radius * radial, glm::normalize(radial + ring.slope * ring.axis),
+                    glm::vec2(Mesh::kCylinderSideU - Mesh::kCylinderSideWidth * (float)j / (float)slices, texV),
+                    glm::vec3(0.0f) };
+            }
+        }
+
+        // 뚜껑, 원기둥 mesh의 뚜껑과 같은 texture 영역
+        const glm::vec2 capCenter = glm::vec2(Mesh::kCylinderCapU, Mesh::kCylinderCapV);
+        auto MeshCap = [&](const Ring& ring, const glm::vec3& capU, const glm::vec3& capV, const glm::vec3& normal) {
+            for (uint32_t j = 0; j < slices; j++) {
+                glm::vec3 radial = circle[j].x * capU + circle[j].y * capV;
+                *out++ = Vertex{ ring.center + ring.radius * radial, normal,
+                    capCenter + Mesh::kCylinderCapRadius * glm::vec2(circle[j].x, -circle[j].y), glm::vec3(0.0f) };
+            }
+        };
+        const auto& tip = rings.back();
+        MeshCap(tip, u, v, tip.axis);
+        if (chain.baseCap)
+            MeshCap(rings.front(), baseU, baseV, -rings.front().axis);
+
+        uint32_t* index = indices.data() + chain.indexOffset;
+        uint32_t base = (uint32_t)chain.vertexOffset;
+        for (uint32_t k = 0; k < chain.segments; k++) {
+            for (uint32_t j = 0; j < slices; j++) {
+                uint32_t a = base + k * ringSize + j;
+                uint32_t b = a + 1;
+                uint32_t c = a + ringSize;
+                uint32_t d = c + 1;
+                *index++ = a; *index++ = c; *index++ = b;
+                *index++ = b; *index++ = c; *index++ = d;
+            }
+        }
+        uint32_t rim = base + (chain.segments + 1) * ringSize;
+        for (uint32_t j = 1; j + 1 < slices; j++) {
+            *index++ = rim;
+            *index++ = rim + j + 1;
+            *index++ = rim + j;
+        }
+        // 아래 뚜껑은 축 반대쪽을 보도록 감는 방향을 뒤집음
+        if (chain.baseCap) {
+            rim += slices;
+            for (uint32_t j = 1; j + 1 < slices; j++) {
+                *index++ = rim;
+                *index++ = rim + j;
+                *index++ = rim + j + 1;
+            }
+        }
+    };
+
+    if (pool) {
+        pool->ParallelFor(chains.size(), MeshChain);
+    }
+    else {
+        for (size_t i = 0; i < chains.size(); i++)
+            MeshChain(i);
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef __BRANCH_MESHER_H__
+#define __BRANCH_MESHER_H__
+
+#include "common.h"
+#include "mesh.h"
+#include "thread_pool.h"
+#include <string>
+#include <vector>
+
+/*
+가지 원기둥 instance 대신 skeleton을 따라 하나로 이어진 mesh를 만듦
+부모에서 이어지는 가지들을 chain으로 묶고 chain마다 원(ring)을 쓸어서 옆면을 만듦
+이웃한 가지는 ring 하나를 같이 쓰고 안쪽 뚜껑은 만들지 않음
+뚜껑은 chain 끝과, 부모 원기둥 밖에서 시작하는 곁가지 chain의 시작에만 있음
+둘레 분할 수는 chain 반지름의 제곱근에 비례해서 가는 바깥 가지일수록 줄임
+옆면 normal은 원기둥 mesh처럼 반지름이 줄어드는 기울기만큼 축 방향으로 기울임
+texture v는 ring마다 위아래를 번갈아 써서 이음매 없이 이어짐
+*/
+class BranchMesher {
+public:
+    struct Params {
+        float radius;  // 원기둥 mesh의 아래 반지름
+        float height;
+        float rate;    // 위 반지름 / 아래 반지름
+        int slices { 50 };     // 아래 반지름이 radius인 가지의 둘레 분할 수
+        int minSlices { 8 };   // 가는 가지도 이보다 적게 나누지 않음
+    };
+
+    // codes의 가지마다 부모 가지 번호 (없으면 -1), 순서는 Turtle이 만드는 가지 행렬 순서
+    static std::vector<int32_t> FindParents(const std::string& codes);
+
+    // instances: 원기둥 mesh 원점 보정까지 적용된 행렬, parents와 개수가 같아야 함
+    // chain 단위로 pool에서 나눠서 만듦
+    static bool Build(const Params& params, const std::vector<glm::mat4>& instances,
+        const std::vector<int32_t>& parents, ThreadPool* pool,
+        std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+};
+
+#endif // __BRANCH_MESHER_H__
\ No newline at end of file
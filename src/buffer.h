@@ -22,6 +22,8 @@ public:
     size_t GetStride() const { return m_stride; }
     size_t GetCount() const { return m_count; }
     void Bind() const;
+    // 버퍼 내용을 새로 채움 (기존 저장공간은 버리고 다시 할당)
+    void SetData(const void* data, size_t count);
 
 private:
     Buffer() {}
@@ -0,0 +1,96 @@
+#include "bvh.h"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+    const uint32_t kLeafSize = 4;
+    const int kMaxStackDepth = 64;
+}
+
+void BVH::Build(const std::vector<AABB>& primitiveBounds) {
+    m_nodes.clear();
+    m_primitiveBounds = primitiveBounds;
+    m_indices.resize(m_primitiveBounds.size());
+    std::iota(m_indices.begin(), m_indices.end(), 0);
+    if (m_indices.empty())
+        return;
+
+    std::vector<glm::vec3> centers(m_primitiveBounds.size());
+    for (size_t i = 0; i < m_primitiveBounds.size(); i++)
+        centers[i] = m_primitiveBounds[i].GetCenter();
+
+    m_nodes.reserve(m_indices.size() * 2);
+    BuildNode(0, (uint32_t)m_indices.size(), centers);
+}
+
+// 중심점 분포가 가장 긴 축의 중앙값으로 분할
+uint32_t BVH::BuildNode(uint32_t first, uint32_t count, const std::vector<glm::vec3>& centers) {
+    uint32_t nodeIndex = (uint32_t)m_nodes.size();
+    m_nodes.push_back(Node());
+
+    AABB bounds;
+    AABB centerBounds;
+    for (uint32_t i = first; i < first + count; i++) {
+        bounds.Expand(m_primitiveBounds[m_indices[i]]);
+        centerBounds.Expand(centers[m_indices[i]]);
+    }
+
+    Node node;
+    node.bounds = bounds;
+    node.first = first;
+    node.count = count;
+
+    glm::vec3 size = centerBounds.max - centerBounds.min;
+    int axis = 0;
+    if (size.y > size[axis]) axis = 1;
+    if (size.z > size[axis]) axis = 2;
+
+    if (count > kLeafSize && size[axis] > 0.0f) {
+        uint32_t mid = first + count / 2;
+        std::nth_element(m_indices.begin() + first, m_indices.begin() + mid,
+            m_indices.begin() + first + count,
+            [&centers, axis](uint32_t a, uint32_t b) { return centers[a][axis] < centers[b][axis]; });
+
+        BuildNode(first, mid - first, centers);
+        node.right = BuildNode(mid, first + count - mid, centers);
+    }
+
+    m_nodes[nodeIndex] = node;
+    return nodeIndex;
+}
+
+void BVH::Cull(const Frustum& frustum, std::vector<uint32_t>& visible) const {
+    visible.clear();
+    if (m_nodes.empty())
+        return;
+
+    uint32_t stack[kMaxStackDepth];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        uint32_t nodeIndex = stack[--top];
+        const auto& node = m_nodes[nodeIndex];
+
+        auto result = frustum.Test(node.bounds);
+        if (result == Frustum::OUTSIDE)
+            continue;
+
+        // 완전히 안쪽이면 서브트리 전체를 검사 없이 추가
+        if (result == Frustum::INSIDE) {
+            visible.insert(visible.end(),
+                m_indices.begin() + node.first, m_indices.begin() + node.first + node.count);
+            continue;
+        }
+
+        if (node.right == 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                if (frustum.Test(m_primitiveBounds[m_indices[i]]) != Frustum::OUTSIDE)
+                    visible.push_back(m_indices[i]);
+            }
+            continue;
+        }
+
+        stack[top++] = node.right;
+        stack[top++] = nodeIndex + 1;
+    }
+}
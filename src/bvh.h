@@ -0,0 +1,38 @@
+#ifndef __BVH_H__
+#define __BVH_H__
+
+#include "common.h"
+#include "bounds.h"
+#include <vector>
+
+/*
+instance 단위 AABB 위에 만든 bounding volume hierarchy
+나무가 바뀔 때만 Build하고 매 프레임 Cull로 frustum 안에 있는 instance 번호만 뽑아냄
+*/
+class BVH {
+public:
+    void Build(const std::vector<AABB>& primitiveBounds);
+    void Cull(const Frustum& frustum, std::vector<uint32_t>& visible) const;
+
+    bool IsEmpty() const { return m_nodes.empty(); }
+    size_t GetPrimitiveCount() const { return m_indices.size(); }
+    AABB GetBounds() const { return m_nodes.empty() ? AABB() : m_nodes[0].bounds; }
+
+private:
+    // 자식이 있으면 왼쪽 자식은 바로 다음 노드, right는 오른쪽 자식 번호
+    // first, count는 서브트리에 속한 primitive의 m_indices 범위
+    struct Node {
+        AABB bounds;
+        uint32_t first { 0 };
+        uint32_t count { 0 };
+        uint32_t right { 0 };
+    };
+
+    uint32_t BuildNode(uint32_t first, uint32_t count, const std::vector<glm::vec3>& centers);
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_indices;
+    std::vector<AABB> m_primitiveBounds;
+};
+
+#endif // __BVH_H__
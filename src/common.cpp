@@ -14,6 +14,36 @@ std::optional<std::string> LoadTextFile(const std::string& filename) {
 	return text.str();
 }
 
+bool WriteFileAtomic(const std::filesystem::path& path, bool binary,
+	const std::function<bool(std::ostream& out)>& write) {
+	auto tempPath = path;
+	tempPath += ".tmp";
+	bool written = false;
+	{
+		std::ofstream out(tempPath, binary ? std::ios::binary : std::ios::out);
+		if (!out.is_open()) {
+			SPDLOG_ERROR("Failed to open file : {}", tempPath.string());
+			return false;
+		}
+		written = write(out);
+		out.close();
+		written = written && !out.fail();
+	}
+
+	std::error_code error;
+	if (!written) {
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+	std::filesystem::rename(tempPath, path, error);
+	if (error) {
+		SPDLOG_ERROR("Failed to write file : {}", path.string());
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+	return true;
+}
+
 // distance를 입력했을 때 kc, kl, kq로 이루어진 vec3를 리턴
 glm::vec3 GetAttenuationCoeff(float distance) {
 	const auto linear_coeff = glm::vec4(8.4523112e-05, 4.4712582e+00, -1.8516388e+00, 3.3955811e+01);
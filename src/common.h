@@ -4,6 +4,9 @@
 #include <memory>
 #include <string>
 #include <optional>
+#include <filesystem>
+#include <functional>
+#include <ostream>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <spdlog/spdlog.h>
@@ -20,6 +23,9 @@ using klassName ## WPtr = std::weak_ptr<klassName>;
 
 // optinal -> 파일을 읽지 못하는 경우를 포인터 없이 편리하게 사용 가능
 std::optional<std::string> LoadTextFile(const std::string& filename);
+// path.tmp에 write로 다 쓴 뒤 path로 이름을 바꿈, write가 false를 돌려주거나 실패하면 temp를 지움
+bool WriteFileAtomic(const std::filesystem::path& path, bool binary,
+    const std::function<bool(std::ostream& out)>& write);
 glm::vec3 GetAttenuationCoeff(float distance);
 float RandomRange(float minValue = 0.0f, float maxValue = 1.0f);
 
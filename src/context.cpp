@@ -1,9 +1,12 @@
 ﻿#include "context.h"
 #include "image.h"
 #include "glm/gtx/string_cast.hpp"
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <charconv>
 #include <filesystem>
+#include <set>
 #include <tuple>
 
 ContextUPtr Context::Create(){
@@ -76,66 +79,70 @@ void Context::Reshape(int width, int height) {
 
 bool Context::Init(){
     glEnable(GL_MULTISAMPLE);
-    m_box = Mesh::CreateBox();
+    m_resources = ResourceManager::Create();
+    if(!m_resources) return false;
+    m_box = m_resources->GetBox();
+    m_box->CreatePositionStream();
 
-    m_simpleProgram = Program::Create("./shader/simple.vs", "./shader/simple.fs");
+    m_simpleProgram = m_resources->GetProgram("./shader/simple.vs", "./shader/simple.fs");
     if(!m_simpleProgram) return false;
 
-    m_program = Program::Create("./shader/lighting.vs", "./shader/lighting.fs");
+    m_program = m_resources->GetProgram("./shader/lighting.vs", "./shader/lighting.fs");
     if(!m_program) return false;
 
-    m_textureProgram = Program::Create("./shader/texture.vs", "./shader/texture.fs");
+    m_textureProgram = m_resources->GetProgram("./shader/texture.vs", "./shader/texture.fs");
     if (!m_textureProgram) return false;
 
-    m_postProgram = Program::Create("./shader/texture.vs", "./shader/gamma.fs");
+    m_postProgram = m_resources->GetProgram("./shader/texture.vs", "./shader/gamma.fs");
     if (!m_postProgram) return false;
 
-    m_lightingShadowProgram = Program::Create("./shader/lighting_shadow.vs", "./shader/lighting_shadow.fs");
+    m_lightingShadowProgram = m_resources->GetProgram("./shader/lighting_shadow.vs", "./shader/lighting_shadow.fs");
     if (!m_lightingShadowProgram) return false;
 
-    m_objProgram = Program::Create("./shader/obj.vs", "./shader/obj.fs");
+    m_depthProgram = m_resources->GetProgram("./shader/depth.vs", "./shader/depth.fs");
+    if (!m_depthProgram) return false;
+
+    m_objProgram = m_resources->GetProgram("./shader/obj.vs", "./shader/obj.fs");
     if(!m_objProgram) return false;
 
-    m_normalProgram = Program::Create("./shader/normal.vs", "./shader/normal.fs");
+    m_normalProgram = m_resources->GetProgram("./shader/normal.vs", "./shader/normal.fs");
     if(!m_normalProgram) return false;
 
     glClearColor(0.0f, 0.1f, 0.2f, 0.0f);
 
-    TexturePtr grayTexture = Texture::CreateFromImage(
-        Image::CreateSingleColorImage(4, 4, glm::vec4(0.5f, 0.5f, 0.5f, 1.0f)).get());
-
     m_planeMaterial = Material::Create();
-    m_planeMaterial->diffuse = Texture::CreateFromImage(Image::Load("./image/marble.jpg").get());
-    m_planeMaterial->specular = grayTexture;
+    m_planeMaterial->diffuse = m_resources->GetTexture("./image/marble.jpg");
+    m_planeMaterial->specular = m_resources->GetSingleColorTexture(glm::vec4(0.5f, 0.5f, 0.5f, 1.0f));
     m_planeMaterial->shininess = 4.0f;
 
-    // cube texture
-    auto cubeRight = Image::Load("./image/skybox/right.jpg", false);
-    auto cubeLeft = Image::Load("./image/skybox/left.jpg", false);
-    auto cubeTop = Image::Load("./image/skybox/top.jpg", false);
-    auto cubeBottom = Image::Load("./image/skybox/bottom.jpg", false);
-    auto cubeFront = Image::Load("./image/skybox/front.jpg", false);
-    auto cubeBack = Image::Load("./image/skybox/back.jpg", false);
-    m_cubeTexture = CubeTexture::CreateFromImages({
-        cubeRight.get(),
-        cubeLeft.get(),
-        cubeTop.get(),
-        cubeBottom.get(),
-        cubeFront.get(),
-        cubeBack.get(),
+    // cube texture, 6장을 worker thread에서 동시에 decode하고 PBO로 모두 올린 뒤 생성
+    // 그 전까지는 skybox를 그리지 않음
+    m_resources->GetLoader()->LoadCubeTexture({
+        "./image/skybox/right.jpg",
+        "./image/skybox/left.jpg",
+        "./image/skybox/top.jpg",
+        "./image/skybox/bottom.jpg",
+        "./image/skybox/front.jpg",
+        "./image/skybox/back.jpg",
+    }, [this](CubeTexturePtr texture) {
+        m_cubeTexture = texture;
     });
-    m_skyboxProgram = Program::Create("./shader/skybox.vs", "./shader/skybox.fs");
+    m_skyboxProgram = m_resources->GetProgram("./shader/skybox.vs", "./shader/skybox.fs");
     if(!m_skyboxProgram) return false;
 
-    m_envMapProgram = Program::Create("./shader/env_map.vs", "./shader/env_map.fs");
+    m_envMapProgram = m_resources->GetProgram("./shader/env_map.vs", "./shader/env_map.fs");
     if(!m_envMapProgram) return false;
 
     m_shadowMap = ShadowMap::Create(1024,1024);
+    if(!m_shadowMap) return false;
+
+    m_drawList = DrawList::Create();
+    if(!m_drawList) return false;
 
-    m_lsystem = LSystem::Create("","", m_treeParam, m_angle, 0);
+    m_lsystem = LSystem::Create(m_resources.get(), "","", m_treeParam, m_angle, 0);
     if(!m_lsystem) return false;
 
-    m_lsystem2 = LSystem::Create("X", "X=F[<X][>X]", m_treeParam, m_angle, 3, 2.0f, true);
+    m_lsystem2 = LSystem::Create(m_resources.get(), "X", "X=F[<X][>X]", m_treeParam, m_angle, 3, 2.0f, true);
     m_lsystem2->Move(-2.0f, -2.0f);
 
     return true;
@@ -143,16 +150,25 @@ bool Context::Init(){
 
 // Main의 while문에서 반복
 void Context::Render() {
+    // decode가 끝난 이미지를 GL에 upload
+    m_resources->Update();
+    if (m_modelLoader && m_modelLoader->IsFinished())
+        FinishOpenObject();
+    m_retiredLoaders.erase(std::remove_if(m_retiredLoaders.begin(), m_retiredLoaders.end(),
+        [](const ModelLoaderUPtr& loader) { return loader->IsFinished(); }), m_retiredLoaders.end());
+    if (m_treeExporter && m_treeExporter->IsFinished())
+        FinishSaveObject();
+
     if (ImGui::BeginMainMenuBar()) {
         if(ImGui::BeginMenu("File")) {
             if(ImGui::MenuItem("Open", "Ctrl+O")) {
                 m_fileDialogOpen.SetTitle("Select *.obj");
-                m_fileDialogOpen.SetTypeFilters({ ".obj"});
+                m_fileDialogOpen.SetTypeFilters({ ".obj", ".tree" });
                 m_fileDialogOpen.Open();
             }
             if(ImGui::MenuItem("Save", "Ctrl+S")) {
                 m_fileDialogSave.SetTitle("Select Folder");
-                m_fileDialogSave.SetTypeFilters({".obj"});
+                m_fileDialogSave.SetTypeFilters({".obj", ".glb", ".tree"});
                 m_fileDialogSave.Open();
             }
             ImGui::EndMenu();
@@ -163,7 +179,7 @@ void Context::Render() {
     // 만약 사용자가 Open 메뉴를 선택했다면
     m_fileDialogOpen.Display();
     if(m_fileDialogOpen.HasSelected()) {
-        OpenObject(m_fileDialogOpen);
+        OpenObject(m_fileDialogOpen.GetSelected().string());
     }
     m_fileDialogOpen.ClearSelected();
 
@@ -190,6 +206,34 @@ void Context::Render() {
             m_cameraPos = glm::vec3(0.0f, 4.0f, 12.0f);
         }
         ImGui::Separator();
+        const auto& drawStats = m_drawList->GetStats();
+        ImGui::Text("draw calls: %u (items: %u, instances: %u)",
+            drawStats.drawCalls, drawStats.items, drawStats.instances);
+        ImGui::Text("program / material changes: %u / %u",
+            drawStats.programChanges, drawStats.materialChanges);
+        ImGui::Text("shadow map renders: %u", m_shadowRenderCount);
+        ImGui::Text("loading assets: %zu", m_resources->GetLoader()->GetPendingCount());
+        if (m_modelLoader) {
+            if (m_modelLoader->IsCanceled()) {
+                ImGui::Text("canceling...");
+            }
+            else {
+                ImGui::ProgressBar(m_modelLoader->GetProgress(), ImVec2(-1.0f, 0.0f), "loading model");
+                if (ImGui::Button("cancel loading"))
+                    m_modelLoader->Cancel();
+            }
+        }
+        if (m_treeExporter) {
+            if (m_treeExporter->IsCanceled()) {
+                ImGui::Text("canceling...");
+            }
+            else {
+                ImGui::ProgressBar(m_treeExporter->GetProgress(), ImVec2(-1.0f, 0.0f), "saving tree");
+                if (ImGui::Button("cancel saving"))
+                    m_treeExporter->Cancel();
+            }
+        }
+        ImGui::Separator();
         if (ImGui::CollapsingHeader("light", ImGuiTreeNodeFlags_DefaultOpen)) {
             ImGui::Checkbox("directional", &m_light.directional);
             ImGui::DragFloat3("position", glm::value_ptr(m_light.position), 0.01f);
@@ -204,6 +248,8 @@ void Context::Render() {
             ImGui::Checkbox("floor", &m_floor);
             ImGui::SameLine();
             ImGui::Checkbox("scenery", &m_scenery);
+            ImGui::SliderInt("shadow cascades", &m_shadowCascades, 1, 4);
+            ImGui::Combo("shadow quality", &m_shadowQuality, m_shadowQualityItems, NUM_SHADOW_QUALITIES);
         }
         ImGui::EndChild();
         ImGui::SetWindowPos(m_UIPos);
@@ -228,6 +274,14 @@ void Context::Render() {
         ImGui::Separator();
         ImGui::DragInt("iteration", &m_iteration, 0.05f, 0, 5);
         ImGui::Checkbox("sphere leaves", &m_sphereLeaves);
+        if(ImGui::Checkbox("merged branches", &m_mergedBranches))
+            m_lsystem->SetMergedBranches(m_mergedBranches);
+        ImGui::Checkbox("glb instancing", &m_glbInstancing);
+        ImGui::Checkbox("obj dedup", &m_objDeduplicate);
+        ImGui::Checkbox("tree bake geometry", &m_treeBake);
+        ImGui::InputInt("seed (0: random)", &m_seed);
+        ImGui::SameLine();
+        ImGui::Text("current %u", m_lsystem->GetSeed());
         if(ImGui::Button("Draw")) {
             m_model.reset();
             // m_floor = true;
@@ -244,6 +298,20 @@ void Context::Render() {
             m_model.reset();
             // m_floor = true;
         }
+        auto cameraCull = m_lsystem->GetCullStats(RenderPass::Opaque);
+        auto lightCull = m_lsystem->GetCullStats(RenderPass::Shadow);
+        // 합친 가지 mesh는 chunk 단위로 culling
+        auto CullText = [](const char* name, const LSystem::CullStats& cull) {
+            if(cull.chunks > 0)
+                ImGui::Text("%s: branch chunk %u / %u, leaf %u / %u (culled leaf %u)", name,
+                    cull.visibleChunks, cull.chunks, cull.visibleLeaves, cull.leaves, cull.leaves - cull.visibleLeaves);
+            else
+                ImGui::Text("%s: branch %u / %u, leaf %u / %u (culled %u)", name,
+                    cull.visibleCylinders, cull.cylinders, cull.visibleLeaves, cull.leaves,
+                    (cull.cylinders - cull.visibleCylinders) + (cull.leaves - cull.visibleLeaves));
+        };
+        CullText("camera", cameraCull);
+        CullText("light", lightCull);
         ImGui::BeginChild("child3", ImVec2(0, 0), true);
         if (ImGui::CollapsingHeader("string", ImGuiTreeNodeFlags_DefaultOpen)) {
             ImGui::TextWrapped("%s",m_lsystem->GetCodes().c_str());
@@ -257,38 +325,16 @@ void Context::Render() {
     if(m_currentItem != CUSTOM_RULES)
         SetRules();
 
-    auto lightView = glm::lookAt(m_light.position,
-        m_light.position + m_light.direction, glm::vec3(0.0f, 1.0f, 0.0f));
-    auto lightProjection = m_light.directional ?
-        glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, 1.0f, 100.0f) :
-        glm::perspective(glm::radians((m_light.cutoff[0] + m_light.cutoff[1]) * 2.0f), 1.0f, 1.0f, 20.0f);
-
     if(m_newCodes){
         m_treeParam = { m_cylinderRadius, m_cylinderHeight, m_leafRadius, m_leafHeight, m_radiusScaling, m_heightScaling };
-        m_lsystem = LSystem::Create(m_gui_axiom, m_gui_rules, m_treeParam, m_angle, m_iteration, m_sphereLeaves);
+        m_lsystem = LSystem::Create(m_resources.get(), m_gui_axiom, m_gui_rules, m_treeParam, m_angle, m_iteration, m_sphereLeaves,
+            0.0f, 0.0f, (uint32_t)m_seed);
+        m_lsystem->SetMergedBranches(m_mergedBranches);
+        m_resources->Collect(); // 이전 나무만 쓰던 mesh 정리
         m_newCodes = false;
+        m_shadowDirty = true;
     }
 
-    // shadowMap을 만들기 위해 shadowMap에 빛의 시점에서의 장면 그리기
-    m_shadowMap->Bind();
-    glClear(GL_DEPTH_BUFFER_BIT);
-    glViewport(0, 0,
-        m_shadowMap->GetShadowMap()->GetWidth(),
-        m_shadowMap->GetShadowMap()->GetHeight());
-    m_simpleProgram->Use();
-    m_simpleProgram->SetUniform("color", glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
-
-    DrawScene(lightProjection, lightView, m_simpleProgram.get()); // 빛의 위치에서 depth 값을 렌더링
-    DrawTree(lightProjection, lightView, m_simpleProgram.get(), m_simpleProgram.get());
-
-    Framebuffer::BindToDefault(); // 렌더링 종료, 원래 프로그램으로 복귀
-    glViewport(0, 0, m_width, m_height);
-
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-    glEnable(GL_DEPTH_TEST);
-    glClearDepth(1.0f);
-    glDepthFunc(GL_LESS);
-
     m_cameraFront =
         glm::rotate(glm::mat4(1.0f), glm::radians(m_cameraYaw), glm::vec3(0.0f, 1.0f, 0.0f)) *
         glm::rotate(glm::mat4(1.0f), glm::radians(m_cameraPitch), glm::vec3(1.0f, 0.0f, 0.0f)) *
@@ -300,8 +346,107 @@ void Context::Render() {
         m_cameraPos,
         m_cameraPos + m_cameraFront,
         m_cameraUp);
-    
-    if(m_scenery) {
+
+    // 빛의 frustum은 고정 크기 대신 scene bounds에 맞춤
+    auto sceneBounds = GetSceneBounds();
+    auto lightView = ComputeLightView(m_light.position, m_light.direction);
+    auto lightProjection = m_light.directional ?
+        FitDirectionalProjection(lightView, sceneBounds) :
+        FitSpotProjection(lightView, glm::radians((m_light.cutoff[0] + m_light.cutoff[1]) * 2.0f), sceneBounds);
+    auto lightTransform = lightProjection * lightView;
+
+    // cascade 개수가 바뀌면 shadow map을 다시 만듦
+    // layer 당 해상도를 1024 / sqrt(n)으로 줄여서 전체 texel 수(메모리, fill)는 1024^2 이하로 유지
+    int shadowLayers = m_light.directional ? m_shadowCascades : 1;
+    if(m_shadowMap->GetLayerCount() != shadowLayers) {
+        int resolution = (int)(1024.0f / glm::sqrt((float)shadowLayers)) / 4 * 4;
+        // 만들지 못하면 이전 shadow map을 계속 씀, cascade 수도 이전 layer 수로 되돌려서 매 frame 다시 만들지 않음
+        auto shadowMap = ShadowMap::Create(resolution, resolution, shadowLayers);
+        if(shadowMap) {
+            m_shadowMap = std::move(shadowMap);
+            m_shadowDirty = true;
+        }
+        else {
+            SPDLOG_ERROR("failed to create shadow map: {}x{}, {} layers", resolution, resolution, shadowLayers);
+            if(m_light.directional) {
+                m_shadowCascades = m_shadowMap->GetLayerCount();
+                shadowLayers = m_shadowCascades;
+            }
+        }
+    }
+
+    std::vector<glm::mat4> shadowTransforms;
+    std::vector<float> cascadeSplits;
+    if(shadowLayers > 1) {
+        CameraFrustum cameraFrustum;
+        cameraFrustum.view = view;
+        cameraFrustum.fovy = glm::radians(45.0f);
+        cameraFrustum.aspect = (float)m_width / (float)m_height;
+        cameraFrustum.zNear = 0.1f;
+        cameraFrustum.zFar = 100.0f;
+        for(const auto& cascade : ComputeCascades(lightView, cameraFrustum, sceneBounds,
+            shadowLayers, m_shadowMap->GetWidth())) {
+            shadowTransforms.push_back(cascade.transform);
+            cascadeSplits.push_back(cascade.splitDistance);
+        }
+    }
+    else {
+        shadowTransforms.push_back(lightTransform);
+    }
+
+    // 빛의 행렬, 바닥, 나무 형태 중 하나라도 바뀌었을 때만 shadow pass를 다시 그림
+    // cascade는 카메라를 따라가므로 카메라가 움직이면 다시 그려짐
+    bool renderShadow = m_shadowDirty ||
+        shadowTransforms != m_shadowLightTransforms ||
+        m_lsystem->GetRevision() != m_shadowTreeRevision ||
+        m_floor != m_shadowFloor;
+
+    // pass 별로 그릴 대상을 모은 뒤 정렬해서 한번에 그림
+    // shadow pass는 cascade 전체를 덮는 fitted frustum으로 한 번만 culling
+    m_drawList->Clear();
+    if(renderShadow) {
+        SubmitScene(RenderPass::Shadow, m_depthProgram.get());
+        SubmitTree(RenderPass::Shadow, Frustum::FromMatrix(lightTransform));
+    }
+
+    auto viewFrustum = Frustum::FromMatrix(projection * view);
+    SubmitScene(RenderPass::Opaque, m_lightingShadowProgram.get());
+    SubmitTree(RenderPass::Opaque, viewFrustum);
+    SubmitObj(RenderPass::Opaque, m_objProgram.get(), viewFrustum);
+
+    // light 렌더링
+    if(!m_light.directional){
+        auto lightModelTransform = glm::translate(glm::mat4(1.0), m_light.position) *
+            glm::scale(glm::mat4(1.0), glm::vec3(0.1f));
+        m_drawList->Submit(RenderPass::Opaque, m_box.get(), m_simpleProgram.get(), nullptr, lightModelTransform);
+    }
+
+    // shadowMap을 만들기 위해 shadowMap에 빛의 시점에서의 장면 그리기
+    if(renderShadow) {
+        glViewport(0, 0, m_shadowMap->GetWidth(), m_shadowMap->GetHeight());
+        for(int i = 0; i < (int)shadowTransforms.size(); i++) {
+            m_shadowMap->BindLayer(i);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            m_drawList->Flush(RenderPass::Shadow, shadowTransforms[i]); // 빛의 위치에서 depth 값을 렌더링
+        }
+
+        m_shadowDirty = false;
+        m_shadowLightTransforms = shadowTransforms;
+        m_shadowTreeRevision = m_lsystem->GetRevision();
+        m_shadowFloor = m_floor;
+        m_shadowRenderCount++;
+    }
+
+    Framebuffer::BindToDefault(); // 렌더링 종료, 원래 프로그램으로 복귀
+    glViewport(0, 0, m_width, m_height);
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
+    glClearDepth(1.0f);
+    glDepthFunc(GL_LESS);
+
+    // skybox는 카메라 위치를 따라다니므로 draw list를 거치지 않고 먼저 그림
+    if(m_scenery && m_cubeTexture) {
         auto skyboxModelTransform =
             glm::translate(glm::mat4(1.0), m_cameraPos) * glm::scale(glm::mat4(1.0), glm::vec3(50.0f));
         m_skyboxProgram->Use();
@@ -311,18 +456,8 @@ void Context::Render() {
         m_box->Draw(m_skyboxProgram.get());
     }
 
-    glm::vec3 lightPos = m_light.position;
-    glm::vec3 lightDir = m_light.direction;
-
-    // light 렌더링
-    if(!m_light.directional){
-        auto lightModelTransform = glm::translate(glm::mat4(1.0), m_light.position) *
-            glm::scale(glm::mat4(1.0), glm::vec3(0.1f));
-        m_simpleProgram->Use();
-        m_simpleProgram->SetUniform("color", glm::vec4(m_light.ambient + m_light.diffuse, 1.0f));
-        m_simpleProgram->SetUniform("transform", projection * view * lightModelTransform);
-        m_box->Draw(m_simpleProgram.get());
-    }
+    m_simpleProgram->Use();
+    m_simpleProgram->SetUniform("color", glm::vec4(m_light.ambient + m_light.diffuse, 1.0f));
 
     // camera & light
     m_lightingShadowProgram->Use();
@@ -338,15 +473,32 @@ void Context::Render() {
     m_lightingShadowProgram->SetUniform("light.diffuse", m_light.diffuse);
     m_lightingShadowProgram->SetUniform("light.specular", m_light.specular);
     m_lightingShadowProgram->SetUniform("blinn", (m_blinn ? 1 : 0));
-    m_lightingShadowProgram->SetUniform("lightTransform", lightProjection * lightView);
+    m_lightingShadowProgram->SetUniform("lightTransform", lightTransform);
+    m_lightingShadowProgram->SetUniform("viewDir", glm::normalize(m_cameraFront));
+    m_lightingShadowProgram->SetUniform("cascadeCount", (int)cascadeSplits.size());
+    for(int i = 0; i < (int)cascadeSplits.size(); i++) {
+        auto index = std::to_string(i);
+        m_lightingShadowProgram->SetUniform("cascadeSplits[" + index + "]", cascadeSplits[i]);
+        m_lightingShadowProgram->SetUniform("cascadeTransforms[" + index + "]", shadowTransforms[i]);
+    }
+    // hardware compare 한 번이 2x2 texel을 섞으므로 4 tap으로 예전 9 tap 3x3 PCF와 비슷한 부드러움
+    static const struct { int samples; float radius; } shadowQualities[NUM_SHADOW_QUALITIES] = {
+        { 1, 0.0f }, { 4, 1.5f }, { 8, 2.0f }, { 16, 2.5f },
+    };
+    m_lightingShadowProgram->SetUniform("shadowSamples", shadowQualities[m_shadowQuality].samples);
+    m_lightingShadowProgram->SetUniform("shadowFilterRadius", shadowQualities[m_shadowQuality].radius);
+    // 종류가 다른 sampler는 같은 texture unit을 쓰면 안 되므로 항상 3, 4번에 나눠서 지정
     glActiveTexture(GL_TEXTURE3);
-    m_shadowMap->GetShadowMap()->Bind();
+    if(m_shadowMap->GetShadowMap())
+        m_shadowMap->GetShadowMap()->Bind();
+    glActiveTexture(GL_TEXTURE4);
+    if(m_shadowMap->GetShadowMapArray())
+        m_shadowMap->GetShadowMapArray()->Bind();
     m_lightingShadowProgram->SetUniform("shadowMap", 3);
+    m_lightingShadowProgram->SetUniform("shadowMapArray", 4);
     glActiveTexture(GL_TEXTURE0);
 
-    DrawScene(projection, view, m_lightingShadowProgram.get());
-    DrawTree(projection, view, m_logProgram.get(), m_leafProgram.get());
-    DrawObj(projection, view, m_objProgram.get());
+    m_drawList->Flush(RenderPass::Opaque, projection * view);
 }
 
 void Context::SetRules() {
@@ -388,116 +540,170 @@ void Context::SetRules() {
     }
 }
 
-// 회전 후 이동 -> 이동행렬 * 회전행렬 (순서)
-void Context::DrawTree(const glm::mat4& projection, const glm::mat4& view, const Program* treeProgram, const Program* leafProgram) {
-    glEnable(GL_BLEND);
-    m_lsystem->Draw(projection, view);
-    // m_lsystem2->Draw(projection, view);
+void Context::SubmitTree(RenderPass pass, const Frustum& frustum) {
+    if(pass == RenderPass::Shadow)
+        m_lsystem->SubmitDepth(m_drawList.get(), frustum);
+    else
+        m_lsystem->Submit(m_drawList.get(), pass, frustum);
+    // m_lsystem2->Submit(m_drawList.get(), pass, frustum);
 }
 
 void Context::Clear() {
     // m_stochastic = false;
     strcpy_s(m_gui_axiom, sizeof(m_gui_axiom), "");
     strcpy_s(m_gui_rules, sizeof(m_gui_rules), "");
-    LSystem::Create(m_gui_axiom, m_gui_rules, m_treeParam, m_angle, 0);
     m_currentItem = CUSTOM_RULES;
     m_newCodes = true;
 }
 
-void Context::OpenObject(ImGui::FileBrowser file) {
-    m_model.reset();
-    std::string selected = file.GetSelected().string();
-    std::size_t pos = selected.rfind('.');
-    std::string tex = selected.substr(0,pos);
+void Context::OpenObject(const std::string& filename) {
+    SPDLOG_INFO("File location : {}", filename);
+    if(std::filesystem::path(filename).extension() == ".tree") {
+        OpenTree(filename);
+        return;
+    }
+    // 이전에 읽던 모델은 취소
+    if (m_modelLoader) {
+        m_modelLoader->Cancel();
+        m_retiredLoaders.push_back(std::move(m_modelLoader));
+    }
+    m_modelLoader = ModelLoader::Create(filename, m_resources->GetLoader()->GetThreadPool());
+}
+
+void Context::FinishOpenObject() {
+    auto loader = std::move(m_modelLoader);
+    std::string selected = loader->GetFilename();
+    if (loader->IsCanceled()) {
+        SPDLOG_INFO("Canceled opening obj : {}", selected);
+        return;
+    }
 
-    SPDLOG_INFO("File location : {}", selected);
-    m_model = Model::Load(selected);
-    if(!m_model) {
+    auto model = loader->CreateModel(m_resources.get());
+    if(!model) {
         // 모델이 생성되지 않았을 때 처리하는 코드
         SPDLOG_ERROR("Failed to open obj : {}", selected);
-        m_model.reset();
         return;
     }
+    m_model = std::move(model);
+
+    std::size_t pos = selected.rfind('.');
+    std::string tex = selected.substr(0,pos);
 
     m_floor = false;
+    m_shadowDirty = true;
     // 동일한 이름의 텍스쳐 파일이 있을 경우 텍스쳐 지정
     if(std::filesystem::exists(tex+".png")) {
         tex+=".png";
-        m_modelTexture = Texture::CreateFromImage(Image::Load(tex, false).get());
+        m_modelTexture = m_resources->GetTexture(tex, false);
     }
     else if(std::filesystem::exists(tex+".jpg")) {
         tex+=".jpg";
-        m_modelTexture = Texture::CreateFromImage(Image::Load(tex, false).get());
+        m_modelTexture = m_resources->GetTexture(tex, false);
     }
     else {
-        m_modelTexture = Texture::CreateFromImage(Image::CreateSingleColorImage(4, 4, glm::vec4(1.0f, 1.0f, 1.0f, 1.0f)).get());
+        m_modelTexture = m_resources->GetSingleColorTexture(glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
     }
+    m_objMaterial = Material::Create();
+    m_objMaterial->diffuse = m_modelTexture;
 
     Clear();
 }
 
+void Context::OpenTree(const std::string& filename) {
+    auto tree = LSystem::CreateFromFile(m_resources.get(), filename);
+    if(!tree) {
+        SPDLOG_ERROR("Failed to open tree : {}", filename);
+        return;
+    }
+    m_lsystem = std::move(tree);
+    m_lsystem->SetMergedBranches(m_mergedBranches);
+    m_resources->Collect(); // 이전 나무만 쓰던 mesh 정리
+    m_shadowDirty = true;
+}
+
 void Context::SaveObject(ImGui::FileBrowser file, const LSystemUPtr& tree) {
     if(tree->isEmpty()) {
         SPDLOG_ERROR("Create tree object before saving *.obj");
         return;
     }
-    std::string selected = file.GetSelected().string();
-    std::string filename = "tree";
-    std::string num = "1";
-
-    if(std::filesystem::exists(selected + "\\" + filename + ".obj")) {
-        int i = 2;
-        while(std::filesystem::exists(selected + "\\" + filename + "(" + num + ")" + ".obj")) {
-            num = std::to_string(i);
-            i++;
-        }
-        filename += "(" + num + ")";
+    if(m_treeExporter) {
+        SPDLOG_ERROR("Saving is already in progress : {}", m_treeExporter->GetPath().string());
+        return;
     }
 
-    if(WriteToFile(selected, filename, tree))
-        SPDLOG_INFO("File saved : {}", selected + "\\" + filename);
+    // 저장 창에서 고른 형식 (SetTypeFilters 순서)
+    const char* extensions[] = { ".obj", ".glb", ".tree" };
+    const TreeExporter::Format formats[] = { TreeExporter::Format::Obj, TreeExporter::Format::Glb, TreeExporter::Format::Tree };
+    int format = file.GetCurrentTypeFilterIndex();
+    if(format < 0 || format > 2) format = 0;
+    std::string extension = extensions[format];
+
+    // 폴더를 한 번만 읽어서 tree, tree(1), tree(2)... 중 비어 있는 가장 작은 이름을 고름
+    std::filesystem::path directory = file.GetSelected();
+    std::set<int> used;
+    std::error_code error;
+    for(const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if(entry.path().extension() != extension) continue;
+        std::string stem = entry.path().stem().string();
+        if(stem == "tree")
+            used.insert(0);
+        else if(stem.size() > 6 && stem.compare(0, 5, "tree(") == 0 && stem.back() == ')') {
+            int num = 0;
+            auto result = std::from_chars(stem.data() + 5, stem.data() + stem.size() - 1, num);
+            if(result.ec == std::errc() && result.ptr == stem.data() + stem.size() - 1 && num > 0)
+                used.insert(num);
+        }
+    }
+    int num = 0;
+    while(used.count(num)) num++;
+    std::string filename = num == 0 ? "tree" : "tree(" + std::to_string(num) + ")";
+
+    TreeExporter::Options options;
+    options.objDeduplicate = m_objDeduplicate;
+    options.glbInstancing = m_glbInstancing;
+    options.treeBake = m_treeBake;
+    m_treeExporter = TreeExporter::Create(tree->GetSnapshot(), directory / (filename + extension), formats[format],
+        options, m_resources->GetLoader()->GetThreadPool());
 }
 
-bool Context::WriteToFile(std::string selected, std::string filename, const LSystemUPtr& tree) {
-    std::ofstream outObj(selected + "\\" + filename + ".obj");
-    std::ofstream outMtl(selected + "\\" + filename + ".mtl");
-    std::string texturePath = selected + "/" + filename + ".png";
-
-    if(!tree->ExportObj(outObj, filename))
-        SPDLOG_ERROR("Faile to export file : {}", selected + "\\" + filename + ".obj");
-    if(!tree->ExportMtl(outMtl, filename))
-        SPDLOG_ERROR("Faile to export file : {}", selected + "\\" + filename + ".mtl");
-    // if(!tree->ExportTexture(texturePath.c_str()))
-    //     SPDLOG_ERROR("Faile to export file : {}", selected + "\\" + filename + ".png");
+void Context::FinishSaveObject() {
+    auto exporter = std::move(m_treeExporter);
+    std::string path = exporter->GetPath().string();
+    if(exporter->IsCanceled())
+        SPDLOG_INFO("Canceled saving : {}", path);
+    else if(exporter->IsSucceeded())
+        SPDLOG_INFO("File saved : {}", path);
+    else
+        SPDLOG_ERROR("Faile to export file : {}", path);
+}
 
-    outObj.close();
-    outMtl.close();
-    return true;
+AABB Context::GetSceneBounds() const {
+    AABB bounds = m_lsystem->GetBounds();
+    if(m_floor)
+        bounds.Expand(m_box->GetBounds().Transform(GetFloorTransform()));
+    if(m_model)
+        bounds.Expand(m_model->GetBounds());
+    return bounds;
 }
 
-void Context::DrawObj(const glm::mat4& projection, const glm::mat4& view, const Program* program) {
+void Context::SubmitObj(RenderPass pass, const Program* program, const Frustum& frustum) {
     if(m_model) {
-        program->Use();
-        program->SetUniform("tex", 0);
-        m_modelTexture->Bind();
-        auto transform = projection * view;
-        program->SetUniform("transform", transform);
-        program->SetUniform("modelTransform", glm::mat4(1.0f));
-        m_model->Draw(program);
+        m_model->Submit(m_drawList.get(), pass, program, glm::mat4(1.0f), m_objMaterial.get(), &frustum);
     }
 }
 
-void Context::DrawScene(const glm::mat4& projection, const glm::mat4& view, const Program* program) {
+void Context::SubmitScene(RenderPass pass, const Program* program) {
     // 바닥
     if(m_floor){
-        program->Use();
-        auto modelTransform =
-            glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.0f, 0.0f)) *
-            glm::scale(glm::mat4(1.0f), glm::vec3(10.0f, 1.0f, 10.0f));
-        auto transform = projection * view * modelTransform;
-        program->SetUniform("transform", transform);
-        program->SetUniform("modelTransform", modelTransform);
-        m_planeMaterial->SetToProgram(program);
-        m_box->Draw(program);
+        auto modelTransform = GetFloorTransform();
+        if(pass == RenderPass::Shadow)
+            m_drawList->Submit(pass, m_box.get(), program, nullptr, modelTransform, true);
+        else
+            m_drawList->Submit(pass, m_box.get(), program, m_planeMaterial.get(), modelTransform);
     }
 }
+
+glm::mat4 Context::GetFloorTransform() const {
+    return glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.0f, 0.0f)) *
+        glm::scale(glm::mat4(1.0f), glm::vec3(10.0f, 1.0f, 10.0f));
+}
\ No newline at end of file
@@ -9,10 +9,14 @@
 #include "texture.h"
 #include "mesh.h"
 #include "model.h"
+#include "model_loader.h"
 #include "framebuffer.h"
 #include "shadow_map.h"
-#include "matrix_stack.h"
+#include "shadow_frustum.h"
 #include "lsystem.h"
+#include "tree_exporter.h"
+#include "draw_list.h"
+#include "resource_manager.h"
 #include <imgui.h>
 #include "imfilebrowser.h"
 
@@ -26,33 +30,43 @@ public:
     void MouseMove(double x, double y);
     void MouseButton(int button, int action, double x, double y);
 
-    void DrawScene(const glm::mat4& projection, const glm::mat4& view, const Program* program);
-    void DrawObj(const glm::mat4& projection, const glm::mat4& view, const Program* program);
-    void DrawTree(const glm::mat4& projection, const glm::mat4& view, const Program* treeProgram, const Program* leafProgram);
+    void SubmitScene(RenderPass pass, const Program* program);
+    void SubmitObj(RenderPass pass, const Program* program, const Frustum& frustum);
+    void SubmitTree(RenderPass pass, const Frustum& frustum);
 
 private:
     Context(){}
     bool Init();
     void Clear();
-    void OpenObject(ImGui::FileBrowser file);
+    // 모델 읽기를 시작만 하고 바로 돌아옴, 다 읽으면 Render에서 FinishOpenObject 호출
+    void OpenObject(const std::string& filename);
+    void FinishOpenObject();
+    // .tree는 바로 읽어서 지금 나무를 바꿈
+    void OpenTree(const std::string& filename);
+    // 나무의 snapshot을 넘겨 저장을 시작만 하고 바로 돌아옴, 다 쓰면 Render에서 FinishSaveObject 호출
     void SaveObject(ImGui::FileBrowser file, const LSystemUPtr& tree);
-    // bool WriteToFile(std::ofstream& out);
-    bool WriteToFile(std::string selected, std::string filename, const LSystemUPtr& tree);
+    void FinishSaveObject();
     void SetRules();
+    // 바닥, 나무, 불러온 모델을 모두 감싸는 world space bounds
+    AABB GetSceneBounds() const;
+    glm::mat4 GetFloorTransform() const;
 
-    ProgramUPtr m_program;
-    ProgramUPtr m_simpleProgram;
-    ProgramUPtr m_textureProgram;
-    ProgramUPtr m_postProgram;
-    ProgramUPtr m_objProgram;
-    MeshUPtr m_box;
+    // texture, program, mesh 공유 (LSystem, Model도 같이 사용)
+    ResourceManagerUPtr m_resources;
+
+    ProgramPtr m_program;
+    ProgramPtr m_simpleProgram;
+    ProgramPtr m_textureProgram;
+    ProgramPtr m_postProgram;
+    ProgramPtr m_objProgram;
+    MeshPtr m_box;
 
     // tree program
-    ProgramUPtr m_leafProgram;
-    ProgramUPtr m_logProgram;
+    ProgramPtr m_leafProgram;
+    ProgramPtr m_logProgram;
 
     // normal map
-    ProgramUPtr m_normalProgram;
+    ProgramPtr m_normalProgram;
 
     // material parameter
     MaterialPtr m_planeMaterial;
@@ -64,17 +78,45 @@ private:
     // framebuffer
     FramebufferUPtr m_framebuffer;
 
+    // 매 프레임 pass 별 draw 요청을 모아서 정렬 후 그림
+    DrawListUPtr m_drawList;
+
     ModelUPtr m_model;
+    ModelLoaderUPtr m_modelLoader;
+    // 취소한 loader는 worker가 끝날 때까지 여기 두었다가 지움 (render thread에서 join하며 기다리지 않도록)
+    std::vector<ModelLoaderUPtr> m_retiredLoaders;
     TexturePtr m_modelTexture;
 
     // cubemap
-    CubeTextureUPtr m_cubeTexture;
-    ProgramUPtr m_skyboxProgram;
-    ProgramUPtr m_envMapProgram;
+    CubeTexturePtr m_cubeTexture;
+    ProgramPtr m_skyboxProgram;
+    ProgramPtr m_envMapProgram;
 
     // shadow map
     ShadowMapUPtr m_shadowMap;
-    ProgramUPtr m_lightingShadowProgram;
+    ProgramPtr m_lightingShadowProgram;
+    ProgramPtr m_depthProgram;
+
+    // directional light일 때 카메라 frustum을 나눌 cascade 개수 (1이면 scene 전체를 한 장에)
+    int m_shadowCascades { 1 };
+
+    // PCF 품질 preset (shadow map 자체는 그대로이고 sample 개수만 바뀜)
+    enum ShadowQuality {
+        SHADOW_HARD,
+        SHADOW_LOW,
+        SHADOW_MEDIUM,
+        SHADOW_HIGH,
+        NUM_SHADOW_QUALITIES
+    };
+    const char* m_shadowQualityItems[NUM_SHADOW_QUALITIES] { "hard (1 tap)", "low (4 taps)", "medium (8 taps)", "high (16 taps)" };
+    int m_shadowQuality { SHADOW_LOW };
+
+    // shadow map은 빛, 바닥, 나무가 바뀔 때만 다시 그림
+    bool m_shadowDirty { true };
+    std::vector<glm::mat4> m_shadowLightTransforms;
+    uint32_t m_shadowTreeRevision { 0 };
+    bool m_shadowFloor { true };
+    uint32_t m_shadowRenderCount { 0 };
 
     // tree
     bool m_newCodes { false };
@@ -90,6 +132,8 @@ private:
     std::vector<float> m_treeParam { m_cylinderRadius, m_cylinderHeight, m_leafRadius, m_leafHeight, m_radiusScaling, m_heightScaling };
     LSystemUPtr m_lsystem;
     LSystemUPtr m_lsystem2;
+    // 한 번에 하나씩만 저장
+    TreeExporterUPtr m_treeExporter;
 
     // light parameter
     struct Light {
@@ -132,6 +176,15 @@ private:
     std::string m_axiom { m_gui_axiom };
     std::string m_rules { m_gui_rules };
     bool m_sphereLeaves { false };
+    // 가지를 skeleton을 따라 이은 하나의 mesh로 그림 (끄면 원기둥 instance)
+    bool m_mergedBranches { true };
+    // .glb로 저장할 때 가지, 잎을 EXT_mesh_gpu_instancing으로 저장 (끄면 모두 합친 mesh)
+    bool m_glbInstancing { true };
+    // .obj로 저장할 때 vt, vn을 중복 없이 쓰고 면에 v/vt/vn 번호를 따로 씀
+    bool m_objDeduplicate { false };
+    // .tree로 저장할 때 skeleton과 함께 변환한 geometry도 저장
+    bool m_treeBake { false };
+    int m_seed { 0 };
 
     enum Rule {
         CUSTOM_RULES,
@@ -0,0 +1,97 @@
+#include "derivation.h"
+#include <sstream>
+
+Derivation::Derivation(const std::string& axiom, const std::string& rules, int iteration, uint32_t seed)
+    : m_axiom(axiom), m_gen(seed) {
+    // MakeCodes와 같은 형식: 한 줄에 "글자=치환 문자열" 하나
+    std::istringstream ss(rules);
+    std::string token;
+    while (std::getline(ss, token, '\n')) {
+        std::size_t pos = token.rfind('=');
+        if (pos == std::string::npos || pos != 1)
+            continue;
+        int letter = LetterIndex(token[0]);
+        if (letter >= 0)
+            m_rules[letter].push_back(token.substr(pos + 1));
+    }
+
+    // 문자열에 어떤 글자가 들어 있는지만 따라가며 치환 번호마다 적용 여부를 미리 정함
+    // 규칙이 여러 개인 글자는 고를 수 있는 규칙의 글자를 모두 넣어서 계산
+    auto LettersOf = [](const std::string& text) {
+        uint32_t mask = 0;
+        for (char symbol : text) {
+            int letter = LetterIndex(symbol);
+            if (letter >= 0)
+                mask |= 1u << letter;
+        }
+        return mask;
+    };
+    uint32_t present = LettersOf(m_axiom);
+    m_enabled.resize((size_t)std::max(iteration, 0) * 4);
+    for (int i = 0; i < iteration; i++) {
+        uint32_t start = present;
+        for (int letter = 0; letter < 4; letter++) {
+            bool enabled = (start & (1u << letter)) && !m_rules[letter].empty();
+            m_enabled[i * 4 + letter] = enabled;
+            if (!enabled)
+                continue;
+            present &= ~(1u << letter);
+            for (const auto& rule : m_rules[letter])
+                present |= LettersOf(rule);
+        }
+    }
+
+    m_frames.push_back({ &m_axiom, 0, 0 });
+}
+
+int Derivation::LetterIndex(char symbol) {
+    for (int i = 0; i < 4; i++) {
+        if (kLetters[i] == symbol)
+            return i;
+    }
+    return -1;
+}
+
+bool Derivation::Next(char& symbol) {
+    const int stepCount = (int)m_enabled.size();
+    while (!m_frames.empty()) {
+        auto& frame = m_frames.back();
+        if (frame.position == frame.text->size()) {
+            m_frames.pop_back();
+            continue;
+        }
+
+        char current = (*frame.text)[frame.position++];
+        int step = frame.step;
+        int letter = LetterIndex(current);
+        // 이 글자를 치환하는 다음 번호를 찾음, 없으면 최종 문자열의 글자
+        if (letter >= 0) {
+            while (step < stepCount && (step % 4 != letter || !m_enabled[step]))
+                step++;
+        }
+        else {
+            step = stepCount;
+        }
+        if (step == stepCount) {
+            symbol = current;
+            return true;
+        }
+
+        const auto& rules = m_rules[letter];
+        size_t index = 0;
+        if (rules.size() > 1) {
+            std::uniform_int_distribution<> dis(0, rules.size() - 1);
+            index = dis(m_gen);
+        }
+        // push_back으로 frame 참조가 무효화될 수 있으므로 마지막에 추가
+        m_frames.push_back({ &rules[index], 0, step + 1 });
+    }
+    return false;
+}
+
+size_t Derivation::Read(char* out, size_t count) {
+    size_t read = 0;
+    while (read < count && Next(out[read]))
+        read++;
+    return read;
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifndef __DERIVATION_H__
+#define __DERIVATION_H__
+
+#include "common.h"
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+LSystem::MakeCodes가 만드는 문자열을 통째로 만들지 않고 앞에서부터 한 글자씩 꺼내는 lazy derivation
+MakeCodes는 반복마다 F, X, A, C 순서로 치환하므로 (iteration * 4)번의 치환을 글자마다 깊이 우선으로 펼침
+메모리는 문자열 길이가 아니라 iteration에만 비례
+규칙이 하나뿐인 글자는 MakeCodes와 결과가 같고, 규칙이 여러 개면 난수를 뽑는 순서가 달라 다른 나무가 나옴
+*/
+class Derivation {
+public:
+    Derivation(const std::string& axiom, const std::string& rules, int iteration, uint32_t seed);
+
+    // 다음 글자를 symbol에 씀, 끝나면 false
+    bool Next(char& symbol);
+    // 최대 count개를 out에 이어 씀, 꺼낸 개수를 돌려줌
+    size_t Read(char* out, size_t count);
+
+private:
+    static constexpr char kLetters[4] = { 'F', 'X', 'A', 'C' };
+    static int LetterIndex(char symbol);
+
+    struct Frame {
+        const std::string* text;
+        size_t position;
+        int step; // 이 frame의 글자에 다음으로 적용할 치환 번호
+    };
+
+    std::string m_axiom;
+    std::vector<std::string> m_rules[4];
+    // 치환 번호마다 실제로 치환하는지 (반복을 시작할 때 문자열에 그 글자가 없으면 MakeCodes는 건너뜀)
+    std::vector<bool> m_enabled;
+    std::vector<Frame> m_frames;
+    std::mt19937 m_gen;
+};
+
+#endif // __DERIVATION_H__
\ No newline at end of file
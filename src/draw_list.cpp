@@ -0,0 +1,169 @@
+#include "draw_list.h"
+
+DrawListUPtr DrawList::Create() {
+    auto drawList = DrawListUPtr(new DrawList());
+    if (!drawList->Init())
+        return nullptr;
+    return std::move(drawList);
+}
+
+bool DrawList::Init() {
+    m_instanceBuffer = Buffer::CreateWithData(GL_ARRAY_BUFFER, GL_STREAM_DRAW,
+        nullptr, sizeof(glm::mat4), 0);
+    return m_instanceBuffer ? true : false;
+}
+
+void DrawList::Submit(RenderPass pass, const Mesh* mesh, const Program* program,
+    const Material* material, const glm::mat4* instances, uint32_t instanceCount,
+    bool positionOnly, int chunk) {
+    if (!mesh || !program || !instances || instanceCount == 0)
+        return;
+    if (chunk >= (int)mesh->GetChunks().size())
+        return;
+
+    DrawItem item;
+    item.pass = pass;
+    item.mesh = mesh;
+    item.program = program;
+    item.material = material;
+    item.instances = instances;
+    item.instanceCount = instanceCount;
+    item.positionOnly = positionOnly && mesh->HasPositionStream();
+    item.chunk = chunk;
+    item.sortKey = MakeSortKey(item);
+    m_items.push_back(item);
+    m_sorted = false;
+
+    m_stats.items++;
+    m_stats.instances += instanceCount;
+}
+
+void DrawList::Submit(RenderPass pass, const Mesh* mesh, const Program* program,
+    const Material* material, const glm::mat4& modelTransform, bool positionOnly, int chunk) {
+    // deque는 push_back 해도 기존 원소의 주소가 바뀌지 않음
+    m_ownedInstances.push_back(modelTransform);
+    Submit(pass, mesh, program, material, &m_ownedInstances.back(), 1, positionOnly, chunk);
+}
+
+void DrawList::Clear() {
+    m_items.clear();
+    m_ownedInstances.clear();
+    m_programIds.clear();
+    m_textureIds.clear();
+    m_meshIds.clear();
+    m_materialIds.clear();
+    m_sorted = false;
+    m_stats = Stats();
+}
+
+/*
+64bit 정렬 키
+[63..60] pass | [59..48] program | [47..32] texture | [31..16] mesh | [15..0] material
+id는 프레임마다 처음 등장한 순서대로 부여, 범위를 넘으면 잘려도 정렬 순서에만 영향이 있음
+*/
+uint64_t DrawList::MakeSortKey(const DrawItem& item) {
+    uint32_t texture = (item.material && item.material->diffuse) ? item.material->diffuse->Get() : 0;
+
+    uint64_t passBits = (uint64_t)item.pass & 0xf;
+    uint64_t programBits = Intern(m_programIds, item.program) & 0xfff;
+    uint64_t textureBits = Intern(m_textureIds, texture) & 0xffff;
+    uint64_t meshBits = Intern(m_meshIds, item.mesh) & 0xffff;
+    uint64_t materialBits = Intern(m_materialIds, item.material) & 0xffff;
+
+    return (passBits << 60) | (programBits << 48) | (textureBits << 32) |
+        (meshBits << 16) | materialBits;
+}
+
+// LSD radix sort (8bit씩), 모든 키가 같은 자리수는 건너뜀
+// 안정 정렬이므로 키가 같으면 제출 순서가 유지됨
+void DrawList::Sort() {
+    size_t count = m_items.size();
+    m_order.resize(count);
+    m_scratch.resize(count);
+    for (size_t i = 0; i < count; i++)
+        m_order[i] = (uint32_t)i;
+
+    for (int shift = 0; shift < 64 && count > 1; shift += 8) {
+        uint32_t histogram[256] = {};
+        for (auto index : m_order)
+            histogram[(m_items[index].sortKey >> shift) & 0xff]++;
+
+        if (histogram[(m_items[m_order[0]].sortKey >> shift) & 0xff] == count)
+            continue;
+
+        uint32_t offset = 0;
+        for (int i = 0; i < 256; i++) {
+            uint32_t bucket = histogram[i];
+            histogram[i] = offset;
+            offset += bucket;
+        }
+        for (auto index : m_order)
+            m_scratch[histogram[(m_items[index].sortKey >> shift) & 0xff]++] = index;
+        m_order.swap(m_scratch);
+    }
+    m_sorted = true;
+}
+
+void DrawList::Flush(RenderPass pass, const glm::mat4& viewProjection) {
+    if (!m_sorted)
+        Sort();
+
+    // 같은 mesh, program, material을 쓰는 연속된 요청은 하나의 instanced draw로 합침
+    struct Batch {
+        const DrawItem* item;
+        uint32_t firstInstance;
+        uint32_t instanceCount;
+    };
+    std::vector<Batch> batches;
+    m_uploadInstances.clear();
+
+    for (auto index : m_order) {
+        const auto& item = m_items[index];
+        if (item.pass != pass)
+            continue;
+
+        if (!batches.empty() &&
+            batches.back().item->mesh == item.mesh &&
+            batches.back().item->program == item.program &&
+            batches.back().item->material == item.material &&
+            batches.back().item->positionOnly == item.positionOnly &&
+            batches.back().item->chunk == item.chunk) {
+            batches.back().instanceCount += item.instanceCount;
+        }
+        else {
+            batches.push_back({ &item, (uint32_t)m_uploadInstances.size(), item.instanceCount });
+        }
+        m_uploadInstances.insert(m_uploadInstances.end(),
+            item.instances, item.instances + item.instanceCount);
+    }
+    if (batches.empty())
+        return;
+
+    m_instanceBuffer->SetData(m_uploadInstances.data(), m_uploadInstances.size());
+
+    const Program* currentProgram = nullptr;
+    const Material* currentMaterial = nullptr;
+    bool materialBound = false;
+    for (const auto& batch : batches) {
+        const auto* item = batch.item;
+        if (item->program != currentProgram) {
+            item->program->Use();
+            item->program->SetUniform("viewProjection", viewProjection);
+            currentProgram = item->program;
+            materialBound = false; // sampler uniform은 program마다 따로 설정해야 함
+            m_stats.programChanges++;
+        }
+        if (!materialBound || item->material != currentMaterial) {
+            if (item->material)
+                item->material->SetToProgram(item->program);
+            currentMaterial = item->material;
+            materialBound = true;
+            m_stats.materialChanges++;
+        }
+
+        item->mesh->DrawInstanced(m_instanceBuffer.get(),
+            (uint64_t)batch.firstInstance * sizeof(glm::mat4), batch.instanceCount, item->positionOnly, item->chunk);
+        // chunk마다 draw call 하나
+        m_stats.drawCalls += item->chunk >= 0 ? 1 : (uint32_t)item->mesh->GetChunks().size();
+    }
+}
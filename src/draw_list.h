@@ -0,0 +1,95 @@
+#ifndef __DRAW_LIST_H__
+#define __DRAW_LIST_H__
+
+#include "common.h"
+#include "buffer.h"
+#include "mesh.h"
+#include "program.h"
+#include <deque>
+#include <unordered_map>
+
+// pass 순서대로 정렬 키의 최상위 비트에 들어감
+enum class RenderPass : uint8_t {
+    Shadow = 0,
+    Opaque,
+    Count
+};
+
+/*
+한 번의 draw 요청
+instances는 Flush 전까지 유효해야 하는 인스턴스 행렬 범위 (model transform)
+chunk가 0 이상이면 mesh의 그 chunk만 그림 (culling 후 일부만 보이는 큰 mesh)
+*/
+struct DrawItem {
+    uint64_t sortKey { 0 };
+    RenderPass pass { RenderPass::Opaque };
+    const Mesh* mesh { nullptr };
+    const Program* program { nullptr };
+    const Material* material { nullptr };
+    const glm::mat4* instances { nullptr };
+    uint32_t instanceCount { 0 };
+    bool positionOnly { false };
+    int chunk { -1 };
+};
+
+CLASS_PTR(DrawList)
+class DrawList {
+public:
+    struct Stats {
+        uint32_t items { 0 };
+        uint32_t instances { 0 };
+        uint32_t drawCalls { 0 };
+        uint32_t programChanges { 0 };
+        uint32_t materialChanges { 0 };
+    };
+
+    static DrawListUPtr Create();
+
+    // positionOnly: depth 전용 program처럼 위치만 읽는 경우 mesh의 position stream 사용
+    void Submit(RenderPass pass, const Mesh* mesh, const Program* program,
+        const Material* material, const glm::mat4* instances, uint32_t instanceCount,
+        bool positionOnly = false, int chunk = -1);
+    // 인스턴스 하나짜리 요청, 행렬은 내부에 복사해둠
+    void Submit(RenderPass pass, const Mesh* mesh, const Program* program,
+        const Material* material, const glm::mat4& modelTransform, bool positionOnly = false, int chunk = -1);
+
+    // pass에 속한 요청을 정렬된 순서로 그림, 각 program에 "viewProjection" uniform 설정
+    void Flush(RenderPass pass, const glm::mat4& viewProjection);
+    void Clear();
+
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    DrawList() {}
+    bool Init();
+    uint64_t MakeSortKey(const DrawItem& item);
+    void Sort();
+
+    template <typename T>
+    static uint32_t Intern(std::unordered_map<T, uint32_t>& ids, T key) {
+        auto it = ids.find(key);
+        if (it != ids.end())
+            return it->second;
+        uint32_t id = (uint32_t)ids.size();
+        ids.emplace(key, id);
+        return id;
+    }
+
+    std::vector<DrawItem> m_items;
+    std::vector<uint32_t> m_order;
+    std::vector<uint32_t> m_scratch;
+    bool m_sorted { false };
+
+    std::deque<glm::mat4> m_ownedInstances;
+    std::vector<glm::mat4> m_uploadInstances;
+    BufferUPtr m_instanceBuffer;
+
+    std::unordered_map<const Program*, uint32_t> m_programIds;
+    std::unordered_map<uint32_t, uint32_t> m_textureIds;
+    std::unordered_map<const Mesh*, uint32_t> m_meshIds;
+    std::unordered_map<const Material*, uint32_t> m_materialIds;
+
+    Stats m_stats;
+};
+
+#endif // __DRAW_LIST_H__
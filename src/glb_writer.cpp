@@ -0,0 +1,319 @@
+#include "glb_writer.h"
+#include "vertex_batch.h"
+#include <glm/gtc/quaternion.hpp>
+#include <fstream>
+#include <iterator>
+
+namespace {
+    const uint32_t kGlbMagic = 0x46546c67;     // "glTF"
+    const uint32_t kChunkJson = 0x4e4f534a;    // "JSON"
+    const uint32_t kChunkBin = 0x004e4942;     // "BIN\0"
+    const int kArrayBuffer = 34962;
+    const int kElementArrayBuffer = 34963;
+    const int kUnsignedShort = 5123;
+    const int kUnsignedInt = 5125;
+    const int kFloat = 5126;
+
+    std::string Join(const std::vector<std::string>& items) {
+        std::string result;
+        for (size_t i = 0; i < items.size(); i++) {
+            if (i > 0)
+                result += ",";
+            result += items[i];
+        }
+        return result;
+    }
+
+    // JSON 문자열 안에 넣을 수 있도록 escape
+    std::string Escape(const std::string& text) {
+        std::string result;
+        for (char c : text) {
+            if (c == '"' || c == '\\')
+                result += '\\';
+            if ((unsigned char)c < 0x20)
+                continue;
+            result += c;
+        }
+        return result;
+    }
+
+    /*
+    행렬을 translation, rotation, scale로 분해 (M = T * R * S)
+    마지막 행이 (0, 0, 0, 1)이 아니거나 축끼리 직교하지 않으면 (shear) false
+    */
+    bool DecomposeTRS(const glm::mat4& matrix, glm::vec3& translation, glm::quat& rotation, glm::vec3& scale) {
+        const float kEpsilon = 1e-4f;
+        if (glm::abs(matrix[0][3]) > kEpsilon || glm::abs(matrix[1][3]) > kEpsilon ||
+            glm::abs(matrix[2][3]) > kEpsilon || glm::abs(matrix[3][3] - 1.0f) > kEpsilon)
+            return false;
+
+        glm::vec3 axis[3] = { glm::vec3(matrix[0]), glm::vec3(matrix[1]), glm::vec3(matrix[2]) };
+        for (int i = 0; i < 3; i++) {
+            scale[i] = glm::length(axis[i]);
+            if (scale[i] < 1e-12f)
+                return false;
+            axis[i] /= scale[i];
+        }
+        if (glm::abs(glm::dot(axis[0], axis[1])) > kEpsilon ||
+            glm::abs(glm::dot(axis[0], axis[2])) > kEpsilon ||
+            glm::abs(glm::dot(axis[1], axis[2])) > kEpsilon)
+            return false;
+        // 좌우가 뒤집힌 행렬은 x scale을 음수로
+        if (glm::dot(glm::cross(axis[0], axis[1]), axis[2]) < 0.0f) {
+            scale.x = -scale.x;
+            axis[0] = -axis[0];
+        }
+
+        translation = glm::vec3(matrix[3]);
+        rotation = glm::normalize(glm::quat_cast(glm::mat3(axis[0], axis[1], axis[2])));
+        return true;
+    }
+
+    // glTF texture 좌표는 image 위쪽이 v = 0
+    glm::vec2 ToGltfTexCoord(const glm::vec2& texCoord) {
+        return glm::vec2(texCoord.x, 1.0f - texCoord.y);
+    }
+}
+
+GlbWriterUPtr GlbWriter::Create(bool instancing) {
+    auto writer = GlbWriterUPtr(new GlbWriter());
+    writer->m_instancing = instancing;
+    return std::move(writer);
+}
+
+int GlbWriter::AddBufferView(const void* data, size_t size, int target) {
+    while (m_bin.size() % 4)
+        m_bin.push_back(0);
+    size_t offset = m_bin.size();
+    m_bin.insert(m_bin.end(), (const uint8_t*)data, (const uint8_t*)data + size);
+
+    auto view = fmt::format("{{\"buffer\":0,\"byteOffset\":{},\"byteLength\":{}", offset, size);
+    if (target)
+        view += fmt::format(",\"target\":{}", target);
+    view += "}";
+    m_bufferViews.push_back(view);
+    return (int)m_bufferViews.size() - 1;
+}
+
+int GlbWriter::AddAccessor(int bufferView, int componentType, size_t count, const char* type,
+    const std::string& extra) {
+    m_accessors.push_back(fmt::format("{{\"bufferView\":{},\"componentType\":{},\"count\":{},\"type\":\"{}\"{}}}",
+        bufferView, componentType, count, type, extra));
+    return (int)m_accessors.size() - 1;
+}
+
+int GlbWriter::AddImage(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        SPDLOG_ERROR("failed to open image: {}", path);
+        return -1;
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.empty())
+        return -1;
+
+    auto extension = path.substr(std::min(path.rfind('.'), path.size()));
+    const char* mimeType = (extension == ".jpg" || extension == ".jpeg") ? "image/jpeg" : "image/png";
+    int view = AddBufferView(data.data(), data.size());
+    m_images.push_back(fmt::format("{{\"bufferView\":{},\"mimeType\":\"{}\"}}", view, mimeType));
+    m_textures.push_back(fmt::format("{{\"sampler\":0,\"source\":{}}}", m_images.size() - 1));
+    return (int)m_textures.size() - 1;
+}
+
+int GlbWriter::AddMaterial(const std::string& name, int texture, const glm::vec4& baseColor,
+    float alphaCutoff, bool doubleSided) {
+    auto pbr = fmt::format("\"baseColorFactor\":[{},{},{},{}],\"metallicFactor\":0,\"roughnessFactor\":1",
+        baseColor.r, baseColor.g, baseColor.b, baseColor.a);
+    if (texture >= 0)
+        pbr += fmt::format(",\"baseColorTexture\":{{\"index\":{}}}", texture);
+
+    auto material = fmt::format("{{\"name\":\"{}\",\"pbrMetallicRoughness\":{{{}}}", Escape(name), pbr);
+    if (alphaCutoff >= 0.0f)
+        material += fmt::format(",\"alphaMode\":\"MASK\",\"alphaCutoff\":{}", alphaCutoff);
+    if (doubleSided)
+        material += ",\"doubleSided\":true";
+    material += "}";
+    m_materials.push_back(material);
+    return (int)m_materials.size() - 1;
+}
+
+std::string GlbWriter::AddPrimitive(const std::vector<glm::vec3>& positions,
+    const std::vector<glm::vec3>& normals, const std::vector<glm::vec2>& texCoords,
+    const std::vector<uint32_t>& indices, int material) {
+    // POSITION accessor에는 min, max가 반드시 있어야 함
+    AABB bounds;
+    for (const auto& position : positions)
+        bounds.Expand(position);
+    auto minMax = fmt::format(",\"min\":[{},{},{}],\"max\":[{},{},{}]",
+        bounds.min.x, bounds.min.y, bounds.min.z, bounds.max.x, bounds.max.y, bounds.max.z);
+
+    int position = AddAccessor(AddBufferView(positions.data(), positions.size() * sizeof(glm::vec3), kArrayBuffer),
+        kFloat, positions.size(), "VEC3", minMax);
+    int normal = AddAccessor(AddBufferView(normals.data(), normals.size() * sizeof(glm::vec3), kArrayBuffer),
+        kFloat, normals.size(), "VEC3");
+    int texCoord = AddAccessor(AddBufferView(texCoords.data(), texCoords.size() * sizeof(glm::vec2), kArrayBuffer),
+        kFloat, texCoords.size(), "VEC2");
+
+    // 가능하면 16bit index
+    int index;
+    if (positions.size() <= kMaxPrimitiveVertices) {
+        std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+        index = AddAccessor(AddBufferView(shortIndices.data(), shortIndices.size() * sizeof(uint16_t), kElementArrayBuffer),
+            kUnsignedShort, shortIndices.size(), "SCALAR");
+    }
+    else {
+        index = AddAccessor(AddBufferView(indices.data(), indices.size() * sizeof(uint32_t), kElementArrayBuffer),
+            kUnsignedInt, indices.size(), "SCALAR");
+    }
+
+    auto primitive = fmt::format("{{\"attributes\":{{\"POSITION\":{},\"NORMAL\":{},\"TEXCOORD_0\":{}}},\"indices\":{}",
+        position, normal, texCoord, index);
+    if (material >= 0)
+        primitive += fmt::format(",\"material\":{}", material);
+    primitive += "}";
+    return primitive;
+}
+
+int GlbWriter::AddGltfMesh(const std::string& name, const std::vector<std::string>& primitives) {
+    m_meshes.push_back(fmt::format("{{\"name\":\"{}\",\"primitives\":[{}]}}", Escape(name), Join(primitives)));
+    return (int)m_meshes.size() - 1;
+}
+
+void GlbWriter::AddMesh(const std::string& name, const std::vector<Vertex>& vertices,
+    const std::vector<uint32_t>& indices, int material, const std::vector<glm::mat4>& instances) {
+    if (vertices.empty() || indices.empty() || instances.empty())
+        return;
+
+    std::vector<glm::vec3> translations;
+    std::vector<glm::vec4> rotations; // x, y, z, w
+    std::vector<glm::vec3> scales;
+    std::vector<const glm::mat4*> baked;
+    for (const auto& matrix : instances) {
+        glm::vec3 translation, scale;
+        glm::quat rotation;
+        if (m_instancing && DecomposeTRS(matrix, translation, rotation, scale)) {
+            translations.push_back(translation);
+            rotations.push_back(glm::vec4(rotation.x, rotation.y, rotation.z, rotation.w));
+            scales.push_back(scale);
+        }
+        else {
+            baked.push_back(&matrix);
+        }
+    }
+    m_stats.instancedCount += translations.size();
+    m_stats.bakedCount += baked.size();
+
+    if (!translations.empty()) {
+        std::vector<glm::vec3> positions(vertices.size());
+        std::vector<glm::vec3> normals(vertices.size());
+        std::vector<glm::vec2> texCoords(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            positions[i] = vertices[i].position;
+            normals[i] = vertices[i].normal;
+            texCoords[i] = ToGltfTexCoord(vertices[i].texCoord);
+        }
+        int mesh = AddGltfMesh(name, { AddPrimitive(positions, normals, texCoords, indices, material) });
+
+        int translation = AddAccessor(AddBufferView(translations.data(), translations.size() * sizeof(glm::vec3)),
+            kFloat, translations.size(), "VEC3");
+        int rotation = AddAccessor(AddBufferView(rotations.data(), rotations.size() * sizeof(glm::vec4)),
+            kFloat, rotations.size(), "VEC4");
+        int scale = AddAccessor(AddBufferView(scales.data(), scales.size() * sizeof(glm::vec3)),
+            kFloat, scales.size(), "VEC3");
+        m_nodes.push_back(fmt::format("{{\"name\":\"{}\",\"mesh\":{},\"extensions\":{{\"EXT_mesh_gpu_instancing\":"
+            "{{\"attributes\":{{\"TRANSLATION\":{},\"ROTATION\":{},\"SCALE\":{}}}}}}}}}",
+            Escape(name), mesh, translation, rotation, scale));
+        m_instancingUsed = true;
+    }
+
+    if (!baked.empty()) {
+        // primitive 하나에 vertex kMaxPrimitiveVertices개 이하가 되도록 instance를 묶어서 16bit index로 저장
+        // template mesh 자체가 그보다 크면 instance마다 32bit index primitive 하나
+        size_t instancesPerPrimitive = std::max<size_t>(1, kMaxPrimitiveVertices / vertices.size());
+        // glTF의 normal은 단위 벡터여야 하므로 VertexBatch가 normal matrix로 변환 후 정규화한 것을 씀
+        VertexBatch batch(vertices);
+        std::vector<std::string> primitives;
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> normals;
+        std::vector<glm::vec2> texCoords;
+        std::vector<uint32_t> meshIndices;
+        for (size_t first = 0; first < baked.size(); first += instancesPerPrimitive) {
+            size_t last = std::min(baked.size(), first + instancesPerPrimitive);
+            size_t vertexCount = vertices.size() * (last - first);
+            positions.resize(vertexCount);
+            normals.resize(vertexCount);
+            texCoords.clear();
+            meshIndices.clear();
+            for (size_t i = first; i < last; i++) {
+                size_t start = texCoords.size();
+                batch.Transform(*baked[i], positions.data() + start, normals.data() + start);
+                for (const auto& vertex : vertices)
+                    texCoords.push_back(ToGltfTexCoord(vertex.texCoord));
+                for (uint32_t index : indices)
+                    meshIndices.push_back((uint32_t)start + index);
+            }
+            primitives.push_back(AddPrimitive(positions, normals, texCoords, meshIndices, material));
+        }
+        int mesh = AddGltfMesh(name, primitives);
+        m_nodes.push_back(fmt::format("{{\"name\":\"{}\",\"mesh\":{}}}", Escape(name), mesh));
+    }
+}
+
+bool GlbWriter::Write(std::ostream& out) const {
+    std::vector<std::string> children;
+    for (size_t i = 0; i < m_nodes.size(); i++)
+        children.push_back(std::to_string(i));
+    auto nodes = m_nodes;
+    nodes.push_back(fmt::format("{{\"name\":\"Tree\",\"children\":[{}]}}", Join(children)));
+
+    std::string json = "{\"asset\":{\"version\":\"2.0\",\"generator\":\"Tree Generator\"}";
+    if (m_instancingUsed) {
+        // 지원하지 않는 loader에서는 instance 하나만 보이므로 required로 지정
+        json += ",\"extensionsUsed\":[\"EXT_mesh_gpu_instancing\"]";
+        json += ",\"extensionsRequired\":[\"EXT_mesh_gpu_instancing\"]";
+    }
+    json += fmt::format(",\"scene\":0,\"scenes\":[{{\"nodes\":[{}]}}]", nodes.size() - 1);
+    json += ",\"nodes\":[" + Join(nodes) + "]";
+    if (!m_meshes.empty())
+        json += ",\"meshes\":[" + Join(m_meshes) + "]";
+    if (!m_materials.empty())
+        json += ",\"materials\":[" + Join(m_materials) + "]";
+    if (!m_textures.empty()) {
+        json += ",\"textures\":[" + Join(m_textures) + "]";
+        json += ",\"images\":[" + Join(m_images) + "]";
+        json += ",\"samplers\":[{\"magFilter\":9729,\"minFilter\":9987,\"wrapS\":10497,\"wrapT\":10497}]";
+    }
+    if (!m_accessors.empty())
+        json += ",\"accessors\":[" + Join(m_accessors) + "]";
+    if (!m_bufferViews.empty())
+        json += ",\"bufferViews\":[" + Join(m_bufferViews) + "]";
+    if (!m_bin.empty())
+        json += fmt::format(",\"buffers\":[{{\"byteLength\":{}}}]", m_bin.size());
+    json += "}";
+
+    // chunk는 4byte 단위, JSON은 공백으로 BIN은 0으로 채움
+    while (json.size() % 4)
+        json += ' ';
+    size_t binSize = (m_bin.size() + 3) & ~(size_t)3;
+    uint64_t totalSize = 12 + 8 + json.size() + (m_bin.empty() ? 0 : 8 + binSize);
+    if (totalSize > 0xffffffffull) {
+        SPDLOG_ERROR("glb file is too large: {} bytes", totalSize);
+        return false;
+    }
+
+    auto WriteU32 = [&out](uint32_t value) { out.write((const char*)&value, sizeof(value)); };
+    WriteU32(kGlbMagic);
+    WriteU32(2);
+    WriteU32((uint32_t)totalSize);
+    WriteU32((uint32_t)json.size());
+    WriteU32(kChunkJson);
+    out.write(json.data(), json.size());
+    if (!m_bin.empty()) {
+        WriteU32((uint32_t)binSize);
+        WriteU32(kChunkBin);
+        out.write((const char*)m_bin.data(), m_bin.size());
+        const char padding[4] = {};
+        out.write(padding, binSize - m_bin.size());
+    }
+    return out.good();
+}
\ No newline at end of file
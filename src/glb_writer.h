@@ -0,0 +1,67 @@
+#ifndef __GLB_WRITER_H__
+#define __GLB_WRITER_H__
+
+#include "common.h"
+#include "mesh.h"
+#include <ostream>
+#include <vector>
+
+/*
+glTF 2.0 binary(.glb) 파일 작성
+instancing이 켜져 있으면 mesh는 한 번만 저장하고 instance 행렬은 EXT_mesh_gpu_instancing의 TRS accessor로 저장
+TRS로 나타낼 수 없는 행렬(shear 등)이나 instancing을 끈 경우는 vertex를 변환해서 하나의 mesh로 합침 (baked)
+baked mesh는 vertex 65535개 이하의 primitive로 나눠서 모두 16bit index로 저장
+image는 파일 내용을 그대로 BIN chunk에 넣음
+*/
+CLASS_PTR(GlbWriter)
+class GlbWriter {
+public:
+    struct Stats {
+        size_t instancedCount { 0 };
+        size_t bakedCount { 0 };
+    };
+
+    static GlbWriterUPtr Create(bool instancing);
+
+    // png, jpg 파일을 embed한 texture 번호, 실패하면 -1
+    int AddImage(const std::string& path);
+    // texture가 -1이면 baseColor만 사용, alphaCutoff가 0 이상이면 alpha MASK
+    int AddMaterial(const std::string& name, int texture, const glm::vec4& baseColor,
+        float alphaCutoff = -1.0f, bool doubleSided = false);
+    // instances마다 vertices, indices를 배치한 node 추가
+    void AddMesh(const std::string& name, const std::vector<Vertex>& vertices,
+        const std::vector<uint32_t>& indices, int material, const std::vector<glm::mat4>& instances);
+
+    bool Write(std::ostream& out) const;
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    GlbWriter() {}
+
+    // BIN chunk 뒤에 4byte 정렬로 붙이고 bufferView 번호를 돌려줌, target이 0이면 생략
+    int AddBufferView(const void* data, size_t size, int target = 0);
+    int AddAccessor(int bufferView, int componentType, size_t count, const char* type,
+        const std::string& extra = std::string());
+    static constexpr size_t kMaxPrimitiveVertices = 0xffff;
+
+    // POSITION, NORMAL, TEXCOORD_0, indices를 올리고 primitive JSON을 돌려줌
+    std::string AddPrimitive(const std::vector<glm::vec3>& positions,
+        const std::vector<glm::vec3>& normals, const std::vector<glm::vec2>& texCoords,
+        const std::vector<uint32_t>& indices, int material);
+    // primitive들을 묶은 glTF mesh 번호
+    int AddGltfMesh(const std::string& name, const std::vector<std::string>& primitives);
+
+    bool m_instancing { true };
+    bool m_instancingUsed { false };
+    std::vector<uint8_t> m_bin;
+    std::vector<std::string> m_bufferViews;
+    std::vector<std::string> m_accessors;
+    std::vector<std::string> m_images;
+    std::vector<std::string> m_textures;
+    std::vector<std::string> m_materials;
+    std::vector<std::string> m_meshes;
+    std::vector<std::string> m_nodes;
+    Stats m_stats;
+};
+
+#endif // __GLB_WRITER_H__
\ No newline at end of file
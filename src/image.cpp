@@ -1,8 +1,10 @@
 #include "image.h"
+#include "mapped_file.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
 #include <stb/stb_image_write.h>
 #include <string>
+#include <new>
 
 ImageUPtr Image::Load(const std::string& filepath, bool flipVertical) {
     auto image = ImageUPtr(new Image());
@@ -12,12 +14,21 @@ ImageUPtr Image::Load(const std::string& filepath, bool flipVertical) {
 }
 
 bool Image::LoadWithStb(const std::string& filepath, bool flipVertical) {
-    stbi_set_flip_vertically_on_load(flipVertical);
-    m_data = stbi_load(filepath.c_str(), &m_width, &m_height, &m_channelCount, 0);
-    if (!m_data) {
+    // 압축된 파일 내용은 map만 하고 decode 결과만 메모리에 남김
+    auto file = MappedFile::Open(filepath);
+    if (!file) {
         SPDLOG_ERROR("failed to load image: {}", filepath);
         return false;
     }
+    // worker thread에서 동시에 decode하므로 전역 설정 대신 thread 별 설정 사용
+    stbi_set_flip_vertically_on_load_thread(flipVertical);
+    m_data = stbi_load_from_memory(file->GetData(), (int)file->GetSize(),
+        &m_width, &m_height, &m_channelCount, 0);
+    if (!m_data) {
+        SPDLOG_ERROR("failed to load image: {} ({})", filepath, stbi_failure_reason());
+        return false;
+    }
+    m_storage = Storage::Stb;
     return true;
 }
 
@@ -32,17 +43,30 @@ bool Image::Allocate(int width, int height, int channelCount) {
     m_width = width;
     m_height = height;
     m_channelCount = channelCount;
-    m_data = (uint8_t*)malloc(m_width * m_height * m_channelCount);
-    return m_data ? true : false;
+    m_data = new (std::nothrow) uint8_t[(size_t)m_width * m_height * m_channelCount];
+    if (!m_data)
+        return false;
+    m_storage = Storage::Owned;
+    return true;
 }
 
 Image::~Image() {
-    if (m_data) {
-        stbi_image_free(m_data);
+    Release();
+}
+
+void Image::Release() {
+    switch (m_storage) {
+        case Storage::Owned: delete[] m_data; break;
+        case Storage::Stb: stbi_image_free(m_data); break;
+        default: break;
     }
+    m_data = nullptr;
+    m_storage = Storage::None;
 }
 
 void Image::SetCheckImage(int gridX, int gridY) {
+    if (!m_data)
+        return;
     for (int j = 0; j < m_height; j++) {
         for (int i = 0; i < m_width; i++) {
             int pos = (j * m_width + i) * m_channelCount;
@@ -6,11 +6,23 @@
 CLASS_PTR(Image)
 class Image {
 public:
+    // 픽셀 메모리를 누가 소유하는지에 따라 해제 방법이 다름
+    enum class Storage {
+        None,   // 데이터 없음 (Release 이후)
+        Owned,  // Allocate로 직접 할당
+        Stb,    // stb_image가 할당, stbi_image_free로 해제
+    };
+
+    // 파일을 map해서 stbi_load_from_memory로 decode
     static ImageUPtr Load(const std::string& filepath, bool flipVertical = true);
     static ImageUPtr Create(int width, int height, int channelCount = 4);
     static ImageUPtr CreateSingleColorImage(int width, int height, const glm::vec4& color);
     ~Image();
 
+    // GPU에 올린 뒤 픽셀 데이터만 해제 (크기 정보는 유지)
+    void Release();
+    Storage GetStorage() const { return m_storage; }
+
     const uint8_t* GetData() const { return m_data; }
     int GetWidth() const { return m_width; }
     int GetHeight() const { return m_height; }
@@ -27,6 +39,7 @@ private:
     int m_height { 0 };
     int m_channelCount { 0 };
     uint8_t* m_data { nullptr };
+    Storage m_storage { Storage::None };
 };
 
 #endif // __IMAGE_H__
\ No newline at end of file
@@ -96,6 +96,9 @@ namespace ImGui
         // default value is 0 (the first type filter)
         void SetCurrentTypeFilterIndex(int index);
 
+        // get currently applied type filter index
+        int GetCurrentTypeFilterIndex() const noexcept;
+
         // when ImGuiFileBrowserFlags_EnterNewFilename is set
         // this function will pre-fill the input dialog with a filename.
         void SetInputName(std::string_view input);
@@ -809,6 +812,11 @@ inline void ImGui::FileBrowser::SetCurrentTypeFilterIndex(int index)
     typeFilterIndex_ = static_cast<unsigned int>(index);
 }
 
+inline int ImGui::FileBrowser::GetCurrentTypeFilterIndex() const noexcept
+{
+    return static_cast<int>(typeFilterIndex_);
+}
+
 inline void ImGui::FileBrowser::SetInputName(std::string_view input)
 {
     if(flags_ & ImGuiFileBrowserFlags_EnterNewFilename)
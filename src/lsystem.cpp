@@ -1,16 +1,31 @@
 #include "lsystem.h"
+#include "tree_file.h"
+#include <algorithm>
 
-LSystemUPtr LSystem::Create(std::string axiom, std::string rules, std::vector<float> treeParam, float angle, int iteration,
-        bool sphere, float xCoord, float zCoord) {
+namespace {
+    uint32_t s_revisionCounter = 0;
+}
+
+LSystemUPtr LSystem::Create(ResourceManager* resources, std::string axiom, std::string rules, std::vector<float> treeParam, float angle, int iteration,
+        bool sphere, float xCoord, float zCoord, uint32_t seed) {
     auto lsystem = LSystemUPtr(new LSystem());
-    if(!lsystem->Init(axiom, rules, treeParam, angle, iteration, sphere, xCoord, zCoord))
+    if(!lsystem->Init(resources, axiom, rules, treeParam, angle, iteration, sphere, xCoord, zCoord, seed))
         return nullptr;
     
     return std::move(lsystem);
 }
 
-bool LSystem::Init(std::string axiom, std::string rules, std::vector<float> treeParam, float angle, int iteration,
-    bool sphere, float xCoord, float zCoord) {
+LSystemUPtr LSystem::CreateFromFile(ResourceManager* resources, const std::string& filename) {
+    auto lsystem = LSystemUPtr(new LSystem());
+    if(!lsystem->InitFromFile(resources, filename))
+        return nullptr;
+
+    return std::move(lsystem);
+}
+
+bool LSystem::Init(ResourceManager* resources, std::string axiom, std::string rules, std::vector<float> treeParam, float angle, int iteration,
+    bool sphere, float xCoord, float zCoord, uint32_t seed) {
+    if(!resources) return false;
     if(treeParam.size() < 6) return false;
     else if(treeParam[4] <= 0.0f && treeParam[5] <= 0.0f) return false;
 
@@ -31,6 +46,14 @@ bool LSystem::Init(std::string axiom, std::string rules, std::vector<float> tree
     m_xCoord = xCoord;
     m_zCoord = zCoord;
 
+    // 0이 아닌 seed를 정해두면 Move로 다시 만들 때나 파일에서 읽을 때도 같은 모양
+    m_seed = seed;
+    if(m_seed == 0) {
+        std::random_device rd;
+        while(m_seed == 0)
+            m_seed = rd();
+    }
+
     std::istringstream ss(rules);
     std::string token;
     while (std::getline(ss, token, '\n')) {
@@ -42,27 +65,95 @@ bool LSystem::Init(std::string axiom, std::string rules, std::vector<float> tree
     // m_cylinderRadius *= 1.3f;
     MakeCylinderMatrices(m_xCoord, m_zCoord);
 
-    m_log = Mesh::CreateCylinder(m_cylinderRadius, m_cylinderHeight, m_radiusScaling);
-    m_leaf = Mesh::CreateLeaf(m_leafRadius, m_leafHeight);
-    m_sphere = Mesh::CreateSphere(m_leafRadius);
+    return InitResources(resources);
+}
 
-    m_leafTexture = Texture::CreateFromImage(Image::Load("./image/leaf2.png").get());
-    m_greenTexture = Texture::CreateFromImage(Image::CreateSingleColorImage(4, 4, glm::vec4(0.27f, 0.334f, 0.118f, 1.0f)).get());
-    m_treeImage = Image::Load("./image/tree.png");
-    m_treeTexture = Texture::CreateFromImage(m_treeImage.get());
+bool LSystem::InitFromFile(ResourceManager* resources, const std::string& filename) {
+    if(!resources) return false;
+    auto file = TreeFile::Open(filename);
+    if(!file) return false;
+
+    const auto& params = file->GetParams();
+    m_axiom = file->GetAxiom();
+    m_rules = file->GetRules();
+    m_codes = file->GetCodes();
+    m_cylinderRadius = params.cylinderRadius;
+    m_cylinderHeight = params.cylinderHeight;
+    m_leafRadius = params.leafRadius;
+    m_leafHeight = params.leafHeight;
+    m_radiusScaling = params.radiusScaling;
+    m_heightScaling = params.heightScaling;
+    m_angle = params.angle;
+    m_iteration = params.iteration;
+    m_seed = params.seed;
+    m_isSphere = params.sphere != 0;
+    m_xCoord = params.xCoord;
+    m_zCoord = params.zCoord;
+    if(m_radiusScaling <= 0.0f || m_heightScaling <= 0.0f) return false;
+
+    // codes와 행렬은 저장된 것을 그대로 쓰므로 rules를 다시 parse하지 않음
+    m_cylinderVector = file->GetCylinders();
+    m_leafVector = file->GetLeaves();
+    MakeCylinderInstances();
+    if(!InitResources(resources)) return false;
+
+    // 저장된 가지 geometry가 있으면 skeleton에서 다시 만들지 않고 그대로 사용
+    const auto& baked = file->GetBakedMeshes();
+    if(!baked.empty()) {
+        const auto& mesh = baked[0];
+        std::vector<Vertex> vertices(mesh.vertexCount);
+        for(uint32_t i = 0; i < mesh.vertexCount; i++)
+            vertices[i] = mesh.Decode(i);
+        std::vector<uint32_t> indices(mesh.indices, mesh.indices + mesh.indexCount);
+        bool valid = std::all_of(indices.begin(), indices.end(),
+            [&mesh](uint32_t index) { return index < mesh.vertexCount; });
+        if(valid && !indices.empty())
+            m_branches = Mesh::Create(vertices, indices, GL_TRIANGLES);
+        if(m_branches) {
+            m_branches->CreatePositionStream();
+            m_branchesDirty = false;
+        }
+    }
+    return true;
+}
 
-    m_logProgram = Program::Create("./shader/cylinder.vs", "./shader/cylinder.fs");
+bool LSystem::InitResources(ResourceManager* resources) {
+    // 인자가 같은 mesh는 이전 나무의 것을 그대로 사용
+    m_log = resources->GetCylinder(m_cylinderRadius, m_cylinderHeight, m_radiusScaling);
+    m_leaf = resources->GetLeaf(m_leafRadius, m_leafHeight);
+    m_sphere = resources->GetSphere(m_leafRadius);
+    m_threadPool = resources->GetLoader() ? resources->GetLoader()->GetThreadPool() : nullptr;
+    m_log->CreatePositionStream();
+    m_sphere->CreatePositionStream();
+    BuildBVH();
+
+    m_leafTexture = resources->GetTexture("./image/leaf2.png");
+    m_greenTexture = resources->GetSingleColorTexture(glm::vec4(0.27f, 0.334f, 0.118f, 1.0f));
+    m_treeTexture = resources->GetTexture("./image/tree.png");
+    if(!m_leafTexture || !m_treeTexture) return false;
+
+    m_treeMaterial = Material::Create();
+    m_treeMaterial->diffuse = m_treeTexture;
+    m_greenMaterial = Material::Create();
+    m_greenMaterial->diffuse = m_greenTexture;
+
+    m_logProgram = resources->GetProgram("./shader/cylinder.vs", "./shader/cylinder.fs");
     if(!m_logProgram) return false;
 
-    m_leafProgram = Program::Create("./shader/leaf.vs", "./shader/leaf.fs");
+    m_leafProgram = resources->GetProgram("./shader/leaf.vs", "./shader/leaf.fs");
     if(!m_leafProgram) return false;
 
+    m_depthProgram = resources->GetProgram("./shader/depth.vs", "./shader/depth.fs");
+    if(!m_depthProgram) return false;
+
+    m_depthAlphaProgram = resources->GetProgram("./shader/depth_alpha.vs", "./shader/depth_alpha.fs");
+    if(!m_depthAlphaProgram) return false;
+
     return true;
 }
 
 std::string LSystem::MakeCodes() {
-    std::random_device rd; // 시드로 사용할 장치
-    std::mt19937 gen(rd()); // 난수 엔진
+    std::mt19937 gen(m_seed); // 난수 엔진
 
     std::string tmp;
 
@@ -135,387 +226,198 @@ std::string LSystem::MakeCodes() {
     return result;
 }
 
-void LSystem::MakeLeafMatrices(glm::mat4 matrices, glm::mat4 scaling, std::vector<glm::mat4>& vector) {
-    auto translate = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, m_cylinderHeight / -2.0f, 0.0f));
-    vector.push_back(matrices * translate * scaling);
-}
-
-// 회전 후 이동 -> 이동행렬 * 회전행렬 (순서)
 void LSystem::MakeCylinderMatrices(float xCoord, float zCoord) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::normal_distribution<float> normalDistFrontGen(0.0f, 2.0f);
-    std::normal_distribution<float> normalDistEndGen(0.0f, 0.5f);
-    std::normal_distribution<float> normalDistAngle(m_angle, 4.0f);
-    std::uniform_real_distribution<float> uniformDist(m_heightScaling - 0.05f, m_heightScaling + 0.05f);
-
-    // 나뭇가지를 생성하는 위치를 결정하는 코드
-    MatrixStack stack(xCoord, zCoord); // 행렬 연산을 위한 스택
-    std::stack<int> stackCount; // pop 하는 수를 정하기 위한 스택
-
-    MatrixStack scalingStack; // 나뭇잎 크기 계산을 위함
-    std::stack<int> scalingCount;
-
-    // stack.pushMatrix(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, m_cylinderHeight/1.7f, 0.0f)));
-    stackCount.push(0);
-    scalingCount.push(0);
-
-    int randomNum;
-    float weight = 1.5f;
-    std::vector<glm::mat4> modelMatrices;
-    std::vector<glm::mat4> leafMatrices;
-
-    int matrixTop = 0;
-    int directionTop = 0;
-    int scalingTop = 0;
-    auto matrixFunction = [&]()-> void {
-        matrixTop = stackCount.top();
-        matrixTop+=1;
-        stackCount.pop();
-        stackCount.push(matrixTop);
-    };
-
-    float randomAngle = 0.0f;
-    glm::mat4 scalingInverse;
-
-    auto coord = glm::translate(glm::mat4(1.0f), glm::vec3(5.0f, 0.0f, 3.0f));
-    for(int i=0; i<m_codes.length(); i++){
-        randomAngle = normalDistAngle(gen);
-        switch(m_codes.at(i)){
-        case 'F': case 'X': case 'A': case 'C':
-            matrixFunction();
-            stack.pushMatrix(glm::scale(glm::mat4(1.0f), glm::vec3(m_radiusScaling, m_heightScaling, m_radiusScaling)) *
-                glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, m_cylinderHeight * (m_heightScaling + 1.0f) / 2.2f, 0.0f))); // 방향
-            modelMatrices.push_back(stack.getCurrentMatrix());
-
-            scalingTop = scalingCount.top();
-            scalingTop+=1;
-            scalingCount.pop();
-            scalingCount.push(scalingTop);
-            // 역행렬이 무조건 존재한다고 가정
-            scalingInverse = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f / m_radiusScaling,
-                1.0f / m_heightScaling, 1.0f / m_radiusScaling));
-            scalingStack.pushMatrix(scalingInverse);
-
-            // randomNum = static_cast<int>(floor((normalDistFrontGen(gen))));
-            // if(randomNum == 0 && !stack.isEmpty() && !scalingStack.isEmpty())
-            //     MakeLeafMatrices(stack.getCurrentMatrix(), scalingStack.getCurrentMatrix(), leafMatrices);
-            break;
-
-        case '+':
-            matrixFunction();
-            stack.pushMatrix(glm::rotate(glm::mat4(1.0f), glm::radians(randomAngle), glm::vec3(0.0f, 1.0f, 0.0f))); // 방향
-            break;
-
-        case '-':
-            matrixFunction();
-            stack.pushMatrix(glm::rotate(glm::mat4(1.0f), glm::radians(-1.0f * randomAngle), glm::vec3(0.0f, 1.0f, 0.0f))); // 방향
-            break;
-
-        case '^':
-            matrixFunction();
-            stack.pushMatrix(glm::rotate(glm::mat4(1.0f), glm::radians(randomAngle), glm::vec3(1.0f, 0.0f, 0.0f)) *
-                glm::translate(glm::mat4(1.0f), glm::vec3(
-                    0.0f, 0.0f, weight * sin(randomAngle * M_PI / 180.0f) * (m_cylinderHeight/2.0f)))); // 방향
-            break;
-
-        case '&':
-            matrixFunction();
-            stack.pushMatrix(glm::rotate(glm::mat4(1.0f), glm::radians(-1.0f * randomAngle), glm::vec3(1.0f, 0.0f, 0.0f)) * 
-                glm::translate(glm::mat4(1.0f),glm::vec3(
-                0.0f, 0.0f,-1.0 * weight *sin(randomAngle * M_PI / 180.0f) * (m_cylinderHeight/2.0f)))); // 방향
-            break;
-
-        case '<':
-            matrixFunction();
-            stack.pushMatrix(glm::rotate(glm::mat4(1.0f), glm::radians(randomAngle), glm::vec3(0.0f, 0.0f, 1.0f)) *
-                glm::translate(glm::mat4(1.0f), glm::vec3(
-                -1.0 * weight * sin(randomAngle * M_PI / 180.0f) * (m_cylinderHeight/2.0f), 0.0f, 0.0f))); // 방향
-            break;
+    Turtle turtle({ m_cylinderHeight, m_radiusScaling, m_heightScaling, m_angle, m_seed, xCoord, zCoord });
+    m_cylinderVector.clear();
+    m_leafVector.clear();
 
-        case '>':
-            matrixFunction();
-            stack.pushMatrix(glm::rotate(glm::mat4(1.0f), glm::radians(-1.0f * randomAngle), glm::vec3(0.0f, 0.0f, 1.0f)) * 
-                glm::translate(glm::mat4(1.0f), glm::vec3(
-                weight * sin(randomAngle * M_PI / 180.0f) * (m_cylinderHeight/2.0f), 0.0f, 0.0f))); // 방향
+    glm::mat4 matrix;
+    for(char symbol : m_codes) {
+        switch(turtle.Step(symbol, matrix)) {
+        case Turtle::Output::Branch:
+            m_cylinderVector.push_back(matrix);
             break;
-
-        case '|':
-            matrixFunction();
-            stack.pushMatrix(glm::rotate(glm::mat4(1.0f), glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f))); // 방향
+        case Turtle::Output::Leaf:
+            m_leafVector.push_back(matrix);
             break;
-
-        case '[':
-            stackCount.push(0);
-            scalingCount.push(0);
-            break;
-
-        case ']':
-            randomNum = static_cast<int>(floor((normalDistEndGen(gen))));
-            if((m_codes.at(i-1) == 'X' || m_codes.at(i-1) == 'F' || m_codes.at(i-1) == 'A' || m_codes.at(i-1) == 'C')
-                && randomNum == 0 || randomNum == -1) {
-                MakeLeafMatrices(stack.getCurrentMatrix(), scalingStack.getCurrentMatrix(), leafMatrices);
-            }
-                
-            for(int i=0; i<stackCount.top(); i++)
-                stack.popMatrix();
-            for(int i=0; i<scalingCount.top(); i++)
-                scalingStack.popMatrix();
-
-            stackCount.pop();
-            scalingCount.pop();
+        default:
             break;
         }
     }
-    m_cylinderVector.clear();
-    m_leafVector.clear();
-    m_cylinderVector = modelMatrices;
-    m_leafVector = leafMatrices;
+    MakeCylinderInstances();
 }
 
-void LSystem::Draw(const glm::mat4& projection, const glm::mat4& view) const {
-    if(!m_codes.empty()) {
-        m_logProgram->Use();
-        m_logProgram->SetUniform("tex", 0);
-        // m_brownTexture->Bind();
-        m_treeTexture->Bind();
-
-        for(int i=0; i<m_cylinderVector.size(); i++) {
-            auto transform = projection * view * m_cylinderVector[i] * glm::translate(glm::mat4(1.0f),
-                glm::vec3(0.0f, -1.0f * m_cylinderHeight, 0.0f));
-            m_logProgram->SetUniform("transform", transform);
-            // m_logProgram->SetUniform("color", glm::vec3(0.6f, 0.4f, 0.2f));
-            // treeProgram->SetUniform("modelTransform", m_modelMatrices[i]);
-            m_log->Draw(m_logProgram.get());
-        }
-
-        m_leafProgram->Use();
-        m_leafProgram->SetUniform("tex", 0);
-        if(m_isSphere) {
-            m_greenTexture->Bind();
-            for(int i=0; i<m_leafVector.size(); i++){
-                m_leafProgram->SetUniform("transform", projection * view * m_leafVector[i]);
-                m_sphere->Draw(m_leafProgram.get());
-            }
-        }
-        else {
-            m_treeTexture->Bind();
-            for(int i=0; i<m_leafVector.size(); i++){
-                m_leafProgram->SetUniform("transform", projection * view * m_leafVector[i]);
-                m_leaf->Draw(m_leafProgram.get());
-            }
-        }
-    }
+void LSystem::MakeCylinderInstances() {
+    auto cylinderOffset = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.0f * m_cylinderHeight, 0.0f));
+    m_cylinderInstances.resize(m_cylinderVector.size());
+    for(size_t i = 0; i < m_cylinderVector.size(); i++)
+        m_cylinderInstances[i] = m_cylinderVector[i] * cylinderOffset;
 }
 
-void LSystem::Move(float xCoord, float zCoord) {
-    if(xCoord == m_xCoord && zCoord == m_zCoord) return;
-
-    m_xCoord = xCoord;
-    m_zCoord = zCoord;
-    MakeCylinderMatrices(xCoord, zCoord);
+void LSystem::BuildBVH() {
+    std::vector<AABB> bounds(m_cylinderInstances.size());
+    for(size_t i = 0; i < m_cylinderInstances.size(); i++)
+        bounds[i] = m_log->GetBounds().Transform(m_cylinderInstances[i]);
+    m_cylinderBVH.Build(bounds);
+
+    const AABB& leafBounds = m_isSphere ? m_sphere->GetBounds() : m_leaf->GetBounds();
+    bounds.resize(m_leafVector.size());
+    for(size_t i = 0; i < m_leafVector.size(); i++)
+        bounds[i] = leafBounds.Transform(m_leafVector[i]);
+    m_leafBVH.Build(bounds);
+    m_revision = ++s_revisionCounter;
+    m_snapshot.reset();
+    m_branches.reset();
+    m_branchesDirty = true;
 }
 
-bool LSystem::ExportObj(std::ofstream& out, std::string material) {
-    if (!out.is_open()) {
-        SPDLOG_ERROR("Failed to open file : {}", std::to_string(out.tellp()));
-        return false;
-    }
-
-    int stride = m_log->GetVertexBuffer()->GetCount();
-    std::vector<Vertex> modelVertex = m_log->GetVertexVector();
-    std::vector<int> modelIndex = m_log->GetIndexVector();
-
-    std::vector<std::tuple<float, float, float>> v;
-    std::vector<std::tuple<float, float>> vt;
-    std::vector<std::tuple<float, float, float>> vn;
-    std::vector<std::tuple<int, int, int>> f;
-
-    for(int i=0; i<m_cylinderVector.size(); i++) {
-        int start = stride * i;
-        // vertex positions
-        auto matrix = m_cylinderVector[i] * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.0f * m_cylinderHeight, 0.0f));
-        for (const auto& vertex : modelVertex) {
-            auto vertexAffine = glm::vec4(vertex.position.x, vertex.position.y, vertex.position.z, 1);
-            auto normalAffine = glm::vec4(vertex.normal.x, vertex.normal.y, vertex.normal.z, 0);
-            vertexAffine = matrix * vertexAffine;
-            normalAffine = matrix * normalAffine;
-
-            v.push_back(std::tuple<float, float, float>(vertexAffine.x, vertexAffine.y, vertexAffine.z));
-            vt.push_back(std::tuple<float, float>(vertex.texCoord.x, vertex.texCoord.y));
-            vn.push_back(std::tuple<float, float, float>(normalAffine.x, normalAffine.y, normalAffine.z));
-        }
-
-        // faces using indices
-        size_t indexCount = modelIndex.size();
-        for (size_t j = 0; j < indexCount; j += 3) {
-            uint32_t index1 = modelIndex[j] + start + 1;
-            uint32_t index2 = modelIndex[j+1] + start + 1;
-            uint32_t index3 = modelIndex[j+2] + start + 1;
-
-            f.push_back(std::tuple<int, int, int>(index1, index2, index3));
-        }
-    }
-
-    out << "# tree generator\n\n";
-    out << "# material\n";
-    out << "mtllib ./" + material + ".mtl\n";
-
-    out << "o Cylinder\n";
-    out << "# vertex coordinates\n";
-    for(int i=0; i<v.size(); i++) {
-        out << "v " << std::get<0>(v[i]) << " " << std::get<1>(v[i]) << " " << std::get<2>(v[i]) << "\n";
-    }
-
-    out << "\n# texture coordinates\n";
-    for(int i=0; i<vt.size(); i++) {
-        out << "vt " << std::get<0>(vt[i]) << " " << std::get<1>(vt[i]) << "\n";
-    }
-
-    out << "\n# normal coordinates\n";
-    for(int i=0; i<vn.size(); i++) {
-        out << "vn " << std::get<0>(vn[i]) << " " << std::get<1>(vn[i]) << " " << std::get<2>(vn[i]) << "\n";
-    }
-
-    out << "\n# face\n";
-    out << "usemtl Tree\n";
-    for(int i=0; i<f.size(); i++) {
-        out << "f "
-                << std::get<0>(f[i]) << "/" << std::get<0>(f[i]) << "/" << std::get<0>(f[i]) << " "
-                << std::get<1>(f[i]) << "/" << std::get<1>(f[i]) << "/" << std::get<1>(f[i]) << " "
-                << std::get<2>(f[i]) << "/" << std::get<2>(f[i]) << "/" << std::get<2>(f[i])
-                << "\n";
-    }
+void LSystem::SetMergedBranches(bool merged) {
+    if(merged == m_mergedBranches) return;
+    m_mergedBranches = merged;
+    m_revision = ++s_revisionCounter; // 그림자도 다시 그림
+    m_snapshot.reset();
+}
 
-    v.clear();
-    vt.clear();
-    vn.clear();
-    f.clear();
-
-    if(m_isSphere) {
-        std::vector<Vertex> sphereVertex = m_sphere->GetVertexVector();
-        std::vector<int> sphereIndex = m_sphere->GetIndexVector();
-        int sphereStart = stride * m_cylinderVector.size();
-
-        int sphereStride = m_sphere->GetVertexBuffer()->GetCount();
-        for(int i = 0; i < m_leafVector.size(); i++) {
-            int start = sphereStride * i;
-            // vertex positions
-            auto matrix = m_leafVector[i];
-            for (const auto& vertex : sphereVertex) {
-                auto vertexAffine = glm::vec4(vertex.position.x, vertex.position.y, vertex.position.z, 1);
-                auto normalAffine = glm::vec4(vertex.normal.x, vertex.normal.y, vertex.normal.z, 0);
-                vertexAffine = matrix * vertexAffine;
-                normalAffine = matrix * normalAffine;
-
-                v.push_back(std::tuple<float, float, float>(vertexAffine.x, vertexAffine.y, vertexAffine.z));
-                vt.push_back(std::tuple<float, float>(vertex.texCoord.x, vertex.texCoord.y));
-                vn.push_back(std::tuple<float, float, float>(normalAffine.x, normalAffine.y, normalAffine.z));
-            }
+// 모양이 바뀐 뒤 처음 그릴 때 한 번만 만듦, 실패하면 다음 모양 변경까지 원기둥 instance 사용
+void LSystem::UpdateBranchMesh() {
+    if(!m_mergedBranches || !m_branchesDirty) return;
+    m_branchesDirty = false;
+    if(m_cylinderInstances.empty()) return;
+
+    // 파일에서 읽은 나무도 codes의 가지 순서가 행렬 순서와 같음
+    auto parents = BranchMesher::FindParents(m_codes);
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    if(!BranchMesher::Build({ m_cylinderRadius, m_cylinderHeight, m_radiusScaling }, m_cylinderInstances, parents,
+        m_threadPool, vertices, indices))
+        return;
+
+    m_branches = Mesh::Create(vertices, indices, GL_TRIANGLES);
+    if(m_branches)
+        m_branches->CreatePositionStream();
+}
 
-            // faces using indices
-            size_t indexCount = sphereIndex.size();
-            for (size_t j = 0; j < indexCount; j += 3) {
-                uint32_t index1 = sphereIndex[j] + sphereStart + start + 1;
-                uint32_t index2 = sphereIndex[j+1] + sphereStart + start + 1;
-                uint32_t index3 = sphereIndex[j+2] + sphereStart + start + 1;
+AABB LSystem::GetBounds() const {
+    AABB bounds = m_cylinderBVH.GetBounds();
+    bounds.Expand(m_leafBVH.GetBounds());
+    return bounds;
+}
 
-                f.push_back(std::tuple<int, int, int>(index1, index2, index3));
-            }
+void LSystem::Cull(RenderPass pass, const Frustum& frustum) {
+    auto& visible = m_visible[(size_t)pass];
+    visible.stats = CullStats();
+    visible.cylinders.clear();
+    visible.leaves.clear();
+    visible.branchChunks.clear();
+    if(m_codes.empty()) return;
+
+    UpdateBranchMesh();
+    if(m_mergedBranches && m_branches) {
+        const auto& chunks = m_branches->GetChunks();
+        for(int i = 0; i < (int)chunks.size(); i++) {
+            if(frustum.Test(chunks[i].bounds) != Frustum::OUTSIDE)
+                visible.branchChunks.push_back(i);
         }
+        visible.stats.chunks = (uint32_t)chunks.size();
+        visible.stats.visibleChunks = (uint32_t)visible.branchChunks.size();
     }
     else {
-        std::vector<Vertex> leafVertex = m_leaf->GetVertexVector();
-        std::vector<int> leafIndex = m_leaf->GetIndexVector();
-        int leafStart = stride * m_cylinderVector.size();
-        
-        int leafStride = m_leaf->GetVertexBuffer()->GetCount();
-        for(int i = 0; i<m_leafVector.size(); i++) {
-            int start = leafStride * i;
-            // vertex positions
-            auto matrix = m_leafVector[i];
-            for (const auto& vertex : leafVertex) {
-                auto vertexAffine = glm::vec4(vertex.position.x, vertex.position.y, vertex.position.z, 1);
-                auto normalAffine = glm::vec4(vertex.normal.x, vertex.normal.y, vertex.normal.z, 0);
-                vertexAffine = matrix * vertexAffine;
-                normalAffine = matrix * normalAffine;
-
-                v.push_back(std::tuple<float, float, float>(vertexAffine.x, vertexAffine.y, vertexAffine.z));
-                vt.push_back(std::tuple<float, float>(vertex.texCoord.x, vertex.texCoord.y));
-                vn.push_back(std::tuple<float, float, float>(normalAffine.x, normalAffine.y, normalAffine.z));
-            }
-
-            // faces using indices
-            size_t indexCount = leafIndex.size();
-            for (size_t j = 0; j < indexCount; j += 3) {
-                uint32_t index1 = leafIndex[j] + leafStart + start + 1;
-                uint32_t index2 = leafIndex[j+1] + leafStart + start + 1;
-                uint32_t index3 = leafIndex[j+2] + leafStart + start + 1;
-
-                f.push_back(std::tuple<int, int, int>(index1, index2, index3));
-            }
-        }
+        m_cylinderBVH.Cull(frustum, visible.indices);
+        visible.cylinders.resize(visible.indices.size());
+        for(size_t i = 0; i < visible.indices.size(); i++)
+            visible.cylinders[i] = m_cylinderInstances[visible.indices[i]];
+        visible.stats.visibleCylinders = (uint32_t)visible.cylinders.size();
     }
 
-    out << "\no Leaf\n";
-    out << "# vertex coordinates\n";
-    for(int i=0; i<v.size(); i++) {
-        out << "v " << std::get<0>(v[i]) << " " << std::get<1>(v[i]) << " " << std::get<2>(v[i]) << "\n";
-    }
+    m_leafBVH.Cull(frustum, visible.indices);
+    visible.leaves.resize(visible.indices.size());
+    for(size_t i = 0; i < visible.indices.size(); i++)
+        visible.leaves[i] = m_leafVector[visible.indices[i]];
 
-    out << "\n# texture coordinates\n";
-    for(int i=0; i<vt.size(); i++) {
-        out << "vt " << std::get<0>(vt[i]) << " " << std::get<1>(vt[i]) << "\n";
-    }
+    visible.stats.cylinders = (uint32_t)m_cylinderInstances.size();
+    visible.stats.leaves = (uint32_t)m_leafVector.size();
+    visible.stats.visibleLeaves = (uint32_t)visible.leaves.size();
+}
 
-    out << "\n# normal coordinates\n";
-    for(int i=0; i<vn.size(); i++) {
-        out << "vn " << std::get<0>(vn[i]) << " " << std::get<1>(vn[i]) << " " << std::get<2>(vn[i]) << "\n";
-    }
+void LSystem::Submit(DrawList* drawList, RenderPass pass, const Frustum& frustum) {
+    Cull(pass, frustum);
+    const auto& visible = m_visible[(size_t)pass];
 
-    out << "\n# face\n";
-    out << "usemtl Tree\n";
-    for(int i=0; i<f.size(); i++) {
-        out << "f "
-                << std::get<0>(f[i]) << "/" << std::get<0>(f[i]) << "/" << std::get<0>(f[i]) << " "
-                << std::get<1>(f[i]) << "/" << std::get<1>(f[i]) << "/" << std::get<1>(f[i]) << " "
-                << std::get<2>(f[i]) << "/" << std::get<2>(f[i]) << "/" << std::get<2>(f[i])
-                << "\n";
-    }
+    SubmitBranches(drawList, pass, m_logProgram.get(), m_treeMaterial.get(), false);
 
-    return true;
+    if(m_isSphere)
+        drawList->Submit(pass, m_sphere.get(), m_leafProgram.get(), m_greenMaterial.get(),
+            visible.leaves.data(), (uint32_t)visible.leaves.size());
+    else
+        drawList->Submit(pass, m_leaf.get(), m_leafProgram.get(), m_treeMaterial.get(),
+            visible.leaves.data(), (uint32_t)visible.leaves.size());
 }
 
-bool LSystem::ExportMtl(std::ofstream& out, std::string texture) {
-    if (!out.is_open()) {
-        SPDLOG_ERROR("Failed to open file : {}", std::to_string(out.tellp()));
-        return false;
+void LSystem::SubmitBranches(DrawList* drawList, RenderPass pass, const Program* program,
+    const Material* material, bool positionOnly) {
+    const auto& visible = m_visible[(size_t)pass];
+    if(!m_mergedBranches || !m_branches) {
+        drawList->Submit(pass, m_log.get(), program, material,
+            visible.cylinders.data(), (uint32_t)visible.cylinders.size(), positionOnly);
+        return;
     }
 
-    out << "# Dice.mtl\n\n";
-
-    out << "newmtl Tree\n\n";
-
-    out << "# ambient color\n";
-    out << "Ka 0.2 0.2 0.2\n\n";
+    // 모두 보이면 mesh 전체를 한 번에 제출
+    if(visible.branchChunks.size() == m_branches->GetChunks().size()) {
+        drawList->Submit(pass, m_branches.get(), program, material, glm::mat4(1.0f), positionOnly);
+        return;
+    }
+    for(int chunk : visible.branchChunks)
+        drawList->Submit(pass, m_branches.get(), program, material, glm::mat4(1.0f), positionOnly, chunk);
+}
 
-    out << "# diffuse color\n";
-    out << "Kd 0.7 0.7 0.7\n\n";
+void LSystem::SubmitDepth(DrawList* drawList, const Frustum& frustum) {
+    Cull(RenderPass::Shadow, frustum);
+    const auto& visible = m_visible[(size_t)RenderPass::Shadow];
 
-    out << "# specular color\n";
-    out << "Ka 0.7 0.7 0.7\n\n";
+    SubmitBranches(drawList, RenderPass::Shadow, m_depthProgram.get(), nullptr, true);
 
-    out << "# Blinn-Phong shading\n";
-    out << "illum 2\n\n";
+    // 구 모양 잎은 불투명하므로 가지와 같은 방식, 평면 잎은 텍스쳐 alpha로 모양을 잘라냄
+    if(m_isSphere)
+        drawList->Submit(RenderPass::Shadow, m_sphere.get(), m_depthProgram.get(), nullptr,
+            visible.leaves.data(), (uint32_t)visible.leaves.size(), true);
+    else
+        drawList->Submit(RenderPass::Shadow, m_leaf.get(), m_depthAlphaProgram.get(), m_treeMaterial.get(),
+            visible.leaves.data(), (uint32_t)visible.leaves.size());
+}
 
-    out << "# texture\n";
-    // out << "map_Kd ./" + texture + ".png\n";
-    out << "map_Kd ./tree.png\n";
+void LSystem::Move(float xCoord, float zCoord) {
+    if(xCoord == m_xCoord && zCoord == m_zCoord) return;
 
-    return true;
+    m_xCoord = xCoord;
+    m_zCoord = zCoord;
+    MakeCylinderMatrices(xCoord, zCoord);
+    BuildBVH();
 }
 
-bool LSystem::ExportTexture(const char* imageOutputPath) {
-    m_treeImage->SaveImage(imageOutputPath);
-    return true;
+std::shared_ptr<const TreeSnapshot> LSystem::GetSnapshot() {
+    if(m_snapshot)
+        return m_snapshot;
+
+    auto snapshot = std::make_shared<TreeSnapshot>();
+    snapshot->params = { m_cylinderRadius, m_cylinderHeight, m_leafRadius, m_leafHeight, m_radiusScaling, m_heightScaling,
+        m_angle, m_iteration, m_seed, m_isSphere ? 1u : 0u, m_xCoord, m_zCoord };
+    snapshot->axiom = m_axiom;
+    snapshot->rules = m_rules;
+    snapshot->codes = m_codes;
+    snapshot->cylinders = m_cylinderVector;
+    snapshot->cylinderInstances = m_cylinderInstances;
+    snapshot->leaves = m_leafVector;
+    snapshot->cylinderVertices = m_log->GetVertexVector();
+    snapshot->cylinderIndices = m_log->GetIndexVector();
+    const Mesh* leaf = m_isSphere ? m_sphere.get() : m_leaf.get();
+    snapshot->leafVertices = leaf->GetVertexVector();
+    snapshot->leafIndices = leaf->GetIndexVector();
+    UpdateBranchMesh();
+    if(m_mergedBranches && m_branches) {
+        snapshot->branchVertices = m_branches->GetVertexVector();
+        snapshot->branchIndices = m_branches->GetIndexVector();
+    }
+    m_snapshot = std::move(snapshot);
+    return m_snapshot;
 }
\ No newline at end of file
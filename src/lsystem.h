@@ -2,10 +2,16 @@
 #define __LSYSTEM_H__
 
 #include "common.h"
-#include "matrix_stack.h"
+#include "turtle.h"
+#include "branch_mesher.h"
 #include "program.h"
 #include "mesh.h"
 #include "texture.h"
+#include "draw_list.h"
+#include "bvh.h"
+#include "resource_manager.h"
+#include "tree_snapshot.h"
+#include <array>
 #include <regex>
 #define _USE_MATH_DEFINES
 #include <math.h>
@@ -20,41 +26,101 @@
 CLASS_PTR(LSystem);
 class LSystem {
 public:
+    struct CullStats {
+        uint32_t visibleCylinders { 0 };
+        uint32_t cylinders { 0 };
+        uint32_t visibleLeaves { 0 };
+        uint32_t leaves { 0 };
+        // 가지를 하나의 mesh로 그릴 때는 원기둥 대신 chunk 단위
+        uint32_t visibleChunks { 0 };
+        uint32_t chunks { 0 };
+    };
+
     // std::vector {cylinderRadius, cylinderHeight, leafRadius, leafHeight, radiusScaling, heightScaling}
-    static LSystemUPtr Create(std::string axiom, std::string rules, std::vector<float> treeParam, float angle, int iteration,
-        bool sphere = false, float xCoord = 0.0f, float zCoord = 0.0f);
+    // texture, program, mesh는 resources에서 받아와서 다른 나무와 공유
+    // seed가 같으면 같은 모양, 0이면 임의의 seed
+    static LSystemUPtr Create(ResourceManager* resources, std::string axiom, std::string rules, std::vector<float> treeParam, float angle, int iteration,
+        bool sphere = false, float xCoord = 0.0f, float zCoord = 0.0f, uint32_t seed = 0);
+    // TreeSnapshot::ExportTree로 저장한 .tree 파일에서 codes, 행렬을 그대로 읽어옴
+    static LSystemUPtr CreateFromFile(ResourceManager* resources, const std::string& filename);
     std::string GetAxiom() { return m_axiom; }
     std::string GetRules() { return m_rules; }
     std::string GetCodes() { return m_codes; }
+    uint32_t GetSeed() const { return m_seed; }
     bool isEmpty() { return m_codes.empty(); }
-    void Draw(const glm::mat4& projection, const glm::mat4& view) const;
+    // frustum 밖의 가지와 잎은 BVH로 걸러내고 보이는 instance만 제출
+    void Submit(DrawList* drawList, RenderPass pass, const Frustum& frustum);
+    // shadow pass 전용: 가지는 위치만 읽는 depth program, 잎은 alpha test만 하는 program으로 제출
+    void SubmitDepth(DrawList* drawList, const Frustum& frustum);
+    const CullStats& GetCullStats(RenderPass pass) const { return m_visible[(size_t)pass].stats; }
+    // 형태가 바뀔 때마다 새로 부여되는 번호 (다른 LSystem 객체와도 겹치지 않음)
+    uint32_t GetRevision() const { return m_revision; }
+    // 가지와 잎 전체를 감싸는 world space bounds
+    AABB GetBounds() const;
     void Move(float xCoord, float zCoord);
-    bool ExportObj(std::ofstream& out, std::string material);
-    bool ExportMtl(std::ofstream& out, std::string texture);
-    bool ExportTexture(const char* imageOutputPath);
+    // 가지를 원기둥 instance 대신 skeleton을 따라 이은 하나의 mesh로 그림 (기본값)
+    // mesh는 처음 그릴 때 만들고, 만들 수 없으면 원기둥 instance로 그림
+    void SetMergedBranches(bool merged);
+    bool IsMergedBranches() const { return m_mergedBranches; }
+    // 파일로 내보낼 데이터의 복사본, 모양이 바뀌기 전까지는 같은 snapshot을 공유
+    std::shared_ptr<const TreeSnapshot> GetSnapshot();
 
 private:
     LSystem() {};
-    bool Init(std::string axiom, std::string rules, std::vector<float> treeParam, float angle, int iteration,
-        bool sphere, float zCoord, float xCoord);
+    bool Init(ResourceManager* resources, std::string axiom, std::string rules, std::vector<float> treeParam, float angle, int iteration,
+        bool sphere, float zCoord, float xCoord, uint32_t seed);
+    bool InitFromFile(ResourceManager* resources, const std::string& filename);
+    // mesh, texture, program을 받아오고 BVH를 만듦
+    bool InitResources(ResourceManager* resources);
     std::string MakeCodes();
     void MakeCylinderMatrices(float xCoord = 0.0f, float zCoord = 0.0f);
-    void MakeLeafMatrices(glm::mat4 matrices, glm::mat4 scaling, std::vector<glm::mat4>& vector);
+    void MakeCylinderInstances();
+    void BuildBVH();
+    void UpdateBranchMesh();
+    void Cull(RenderPass pass, const Frustum& frustum);
+    // Cull한 결과의 가지를 합친 mesh 또는 원기둥 instance로 제출
+    void SubmitBranches(DrawList* drawList, RenderPass pass, const Program* program,
+        const Material* material, bool positionOnly);
 
-    ProgramUPtr m_logProgram;
-    ProgramUPtr m_leafProgram;
+    ProgramPtr m_logProgram;
+    ProgramPtr m_leafProgram;
+    ProgramPtr m_depthProgram;
+    ProgramPtr m_depthAlphaProgram;
 
-    MeshUPtr m_log;
-    MeshUPtr m_leaf;
-    MeshUPtr m_sphere;
+    MeshPtr m_log;
+    MeshPtr m_leaf;
+    MeshPtr m_sphere;
+    MeshPtr m_branches; // 나무마다 따로 만드는 가지 mesh (world space)
+    bool m_mergedBranches { true };
+    bool m_branchesDirty { true };
+    ThreadPool* m_threadPool { nullptr };
 
-    ImageUPtr m_treeImage;
     TexturePtr m_leafTexture;
     TexturePtr m_greenTexture;
     TexturePtr m_treeTexture;
 
+    MaterialPtr m_treeMaterial;
+    MaterialPtr m_greenMaterial;
+
     std::vector<glm::mat4> m_cylinderVector;
+    std::vector<glm::mat4> m_cylinderInstances; // 원기둥 mesh 원점 보정까지 적용된 instance 행렬
     std::vector<glm::mat4> m_leafVector;
+
+    // 나무가 바뀔 때만 다시 만듦
+    BVH m_cylinderBVH;
+    BVH m_leafBVH;
+
+    // pass 별로 Flush 전까지 유지되어야 하는 보이는 instance 목록
+    struct VisibleSet {
+        std::vector<uint32_t> indices;
+        std::vector<glm::mat4> cylinders;
+        std::vector<glm::mat4> leaves;
+        std::vector<int> branchChunks;
+        CullStats stats;
+    };
+    std::array<VisibleSet, (size_t)RenderPass::Count> m_visible;
+    uint32_t m_revision { 0 };
+    std::shared_ptr<const TreeSnapshot> m_snapshot; // 모양이 바뀌면 버림
     std::string m_axiom;
     std::string m_rules;
 
@@ -68,6 +134,7 @@ private:
     float m_angle;
     int m_iteration;
     bool m_isSphere;
+    uint32_t m_seed { 0 };
 
     float m_xCoord;
     float m_zCoord;
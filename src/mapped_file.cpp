@@ -0,0 +1,92 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFileUPtr MappedFile::Open(const std::string& filepath) {
+    auto file = MappedFileUPtr(new MappedFile());
+    if (!file->Map(filepath))
+        return nullptr;
+    return std::move(file);
+}
+
+#ifdef _WIN32
+bool MappedFile::Map(const std::string& filepath) {
+    HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        SPDLOG_ERROR("failed to open file: {}", filepath);
+        return false;
+    }
+    m_file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        SPDLOG_ERROR("failed to map empty file: {}", filepath);
+        return false;
+    }
+    m_size = (size_t)size.QuadPart;
+
+    m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping) {
+        SPDLOG_ERROR("failed to map file: {}", filepath);
+        return false;
+    }
+    m_data = (const uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!m_data) {
+        SPDLOG_ERROR("failed to map file: {}", filepath);
+        return false;
+    }
+    return true;
+}
+
+MappedFile::~MappedFile() {
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (m_file)
+        CloseHandle(m_file);
+}
+#else
+bool MappedFile::Map(const std::string& filepath) {
+    m_file = open(filepath.c_str(), O_RDONLY);
+    if (m_file < 0) {
+        SPDLOG_ERROR("failed to open file: {}", filepath);
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(m_file, &status) != 0 || status.st_size == 0) {
+        SPDLOG_ERROR("failed to map empty file: {}", filepath);
+        return false;
+    }
+    m_size = (size_t)status.st_size;
+
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+    if (data == MAP_FAILED) {
+        SPDLOG_ERROR("failed to map file: {}", filepath);
+        return false;
+    }
+    m_data = (const uint8_t*)data;
+    // 처음부터 끝까지 한 번에 읽어나가므로 미리 읽기 요청
+    madvise(data, m_size, MADV_SEQUENTIAL);
+    return true;
+}
+
+MappedFile::~MappedFile() {
+    if (m_data)
+        munmap((void*)m_data, m_size);
+    if (m_file >= 0)
+        close(m_file);
+}
+#endif
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "mesh.h"
 #define _USE_MATH_DEFINES
 #include <math.h>
+#include <algorithm>
 
 MeshUPtr Mesh::Create(const std::vector<Vertex>& vertices,
     const std::vector<uint32_t>& indices, uint32_t primitiveType) {
@@ -13,22 +14,132 @@ MeshUPtr Mesh::Create(const std::vector<Vertex>& vertices,
 void Mesh::Init(const std::vector<Vertex>& vertices,
     const std::vector<uint32_t>& indices, uint32_t primitiveType) {
 
+    m_primitiveType = primitiveType;
     if (primitiveType == GL_TRIANGLES) {
         ComputeTangents(const_cast<std::vector<Vertex>&>(vertices), indices);
     }
 
+    InitBuffers(vertices.data(), vertices.size(), indices.data(), indices.size());
+
+    m_bounds = AABB();
+    for (const auto& vertex : vertices)
+        m_bounds.Expand(vertex.position);
+}
+
+MeshUPtr Mesh::CreateFromData(const Vertex* vertices, size_t vertexCount,
+    const uint32_t* indices, size_t indexCount, uint32_t primitiveType, const AABB& bounds) {
+    auto mesh = MeshUPtr(new Mesh());
+    mesh->m_primitiveType = primitiveType;
+    mesh->InitBuffers(vertices, vertexCount, indices, indexCount);
+    mesh->m_bounds = bounds;
+    return std::move(mesh);
+}
+
+void Mesh::InitBuffers(const Vertex* vertices, size_t vertexCount,
+    const uint32_t* indices, size_t indexCount) {
+    // 대부분은 chunk 하나, 삼각형이 아닌 큰 mesh만 나누지 않고 32bit index로 그림
+    std::vector<uint16_t> shortIndices;
+    m_chunks.clear();
+    if (vertexCount > kMaxChunkVertices && m_primitiveType == GL_TRIANGLES) {
+        shortIndices = BuildChunks(vertices, vertexCount, indices, indexCount);
+    }
+    else {
+        m_vertexVector.assign(vertices, vertices + vertexCount);
+        m_indexVector.assign(indices, indices + indexCount);
+        Chunk chunk { 0, (uint32_t)indexCount, 0, (uint32_t)vertexCount, AABB() };
+        for (size_t i = 0; i < vertexCount; i++)
+            chunk.bounds.Expand(vertices[i].position);
+        m_chunks.push_back(chunk);
+        if (vertexCount <= kMaxChunkVertices)
+            shortIndices.assign(indices, indices + indexCount);
+    }
+    m_indexType = (vertexCount <= kMaxChunkVertices || m_primitiveType == GL_TRIANGLES) ?
+        GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
     m_vertexLayout = VertexLayout::Create();
     m_vertexBuffer = Buffer::CreateWithData(GL_ARRAY_BUFFER, GL_STATIC_DRAW,
-        vertices.data(), sizeof(Vertex), vertices.size());
-    m_indexBuffer = Buffer::CreateWithData(GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW,
-        indices.data(), sizeof(uint32_t), indices.size());
+        m_vertexVector.data(), sizeof(Vertex), m_vertexVector.size());
+    if (m_indexType == GL_UNSIGNED_SHORT)
+        m_indexBuffer = Buffer::CreateWithData(GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW,
+            shortIndices.data(), sizeof(uint16_t), shortIndices.size());
+    else
+        m_indexBuffer = Buffer::CreateWithData(GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW,
+            m_indexVector.data(), sizeof(uint32_t), m_indexVector.size());
     m_vertexLayout->SetAttrib(0, 3, GL_FLOAT, false, sizeof(Vertex), 0); // position
     m_vertexLayout->SetAttrib(1, 3, GL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, normal)); // normal
     m_vertexLayout->SetAttrib(2, 2, GL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, texCoord)); // tex
     m_vertexLayout->SetAttrib(3, 3, GL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, tangent)); // tex
+}
 
-    m_vertexVector.assign(vertices.begin(), vertices.end());
-    m_indexVector.assign(indices.begin(), indices.end());
+// 삼각형을 중심의 Morton 순서로 정렬한 뒤 앞에서부터 vertex가 kMaxChunkVertices개를 넘지 않게 묶음
+// chunk 경계에 걸친 vertex는 양쪽 chunk에 복사
+std::vector<uint16_t> Mesh::BuildChunks(const Vertex* vertices, size_t vertexCount,
+    const uint32_t* indices, size_t indexCount) {
+    size_t triangleCount = indexCount / 3;
+    AABB bounds;
+    for (size_t i = 0; i < vertexCount; i++)
+        bounds.Expand(vertices[i].position);
+    glm::vec3 extent = bounds.max - bounds.min;
+
+    // 0 ~ 1023 값의 bit 사이에 0을 두 개씩 끼움
+    auto SpreadBits = [](uint32_t v) {
+        v &= 0x3ff;
+        v = (v | (v << 16)) & 0x030000ff;
+        v = (v | (v << 8)) & 0x0300f00f;
+        v = (v | (v << 4)) & 0x030c30c3;
+        v = (v | (v << 2)) & 0x09249249;
+        return v;
+    };
+    auto Quantize = [](float value, float minValue, float extent) {
+        float t = extent > 0.0f ? (value - minValue) / extent : 0.0f;
+        return (uint32_t)(glm::clamp(t, 0.0f, 1.0f) * 1023.0f);
+    };
+    std::vector<std::pair<uint32_t, uint32_t>> order(triangleCount); // Morton code, 삼각형 번호
+    for (size_t i = 0; i < triangleCount; i++) {
+        const uint32_t* corner = indices + i * 3;
+        glm::vec3 center = (vertices[corner[0]].position + vertices[corner[1]].position +
+            vertices[corner[2]].position) / 3.0f;
+        uint32_t code = SpreadBits(Quantize(center.x, bounds.min.x, extent.x)) |
+            (SpreadBits(Quantize(center.y, bounds.min.y, extent.y)) << 1) |
+            (SpreadBits(Quantize(center.z, bounds.min.z, extent.z)) << 2);
+        order[i] = { code, (uint32_t)i };
+    }
+    std::sort(order.begin(), order.end());
+
+    std::vector<uint32_t> owner(vertexCount, UINT32_MAX); // 마지막으로 넣은 chunk 번호
+    std::vector<uint32_t> local(vertexCount);
+    std::vector<uint16_t> shortIndices;
+    shortIndices.reserve(triangleCount * 3);
+    m_vertexVector.clear();
+    m_indexVector.clear();
+    m_indexVector.reserve(triangleCount * 3);
+
+    Chunk chunk { 0, 0, 0, 0, AABB() };
+    uint32_t chunkId = 0;
+    for (const auto& entry : order) {
+        // 삼각형 하나가 새로 넣는 vertex는 최대 3개
+        if (chunk.vertexCount + 3 > kMaxChunkVertices) {
+            m_chunks.push_back(chunk);
+            chunk = { (uint32_t)shortIndices.size(), 0, (int32_t)m_vertexVector.size(), 0, AABB() };
+            chunkId++;
+        }
+        const uint32_t* corner = indices + (size_t)entry.second * 3;
+        for (int k = 0; k < 3; k++) {
+            uint32_t index = corner[k];
+            if (owner[index] != chunkId) {
+                owner[index] = chunkId;
+                local[index] = chunk.vertexCount++;
+                m_vertexVector.push_back(vertices[index]);
+                chunk.bounds.Expand(vertices[index].position);
+            }
+            shortIndices.push_back((uint16_t)local[index]);
+            m_indexVector.push_back(chunk.baseVertex + local[index]);
+        }
+        chunk.indexCount += 3;
+    }
+    if (chunk.indexCount > 0)
+        m_chunks.push_back(chunk);
+    return shortIndices;
 }
 
 void Mesh::Draw(const Program* program) const {
@@ -37,7 +148,53 @@ void Mesh::Draw(const Program* program) const {
         m_material->SetToProgram(program);
     }
 
-    glDrawElements(m_primitiveType, m_indexBuffer->GetCount(), GL_UNSIGNED_INT, 0);
+    for (const auto& chunk : m_chunks)
+        DrawChunk(chunk, 0);
+}
+
+void Mesh::DrawInstanced(const Buffer* instanceBuffer, uint64_t offset, uint32_t instanceCount,
+    bool positionOnly, int chunk) const {
+    const VertexLayout* layout = (positionOnly && m_positionLayout) ?
+        m_positionLayout.get() : m_vertexLayout.get();
+    layout->Bind();
+    instanceBuffer->Bind();
+    for (uint32_t i = 0; i < 4; i++) {
+        layout->SetAttrib(4 + i, 4, GL_FLOAT, false, sizeof(glm::mat4), offset + sizeof(glm::vec4) * i);
+        layout->SetAttribDivisor(4 + i, 1);
+    }
+
+    if (chunk >= 0 && chunk < (int)m_chunks.size()) {
+        DrawChunk(m_chunks[chunk], instanceCount);
+        return;
+    }
+    for (const auto& each : m_chunks)
+        DrawChunk(each, instanceCount);
+}
+
+// instanceCount가 0이면 instancing 없이 그림
+void Mesh::DrawChunk(const Chunk& chunk, uint32_t instanceCount) const {
+    size_t indexSize = m_indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+    const void* offset = (const void*)((size_t)chunk.firstIndex * indexSize);
+    if (instanceCount > 0)
+        glDrawElementsInstancedBaseVertex(m_primitiveType, chunk.indexCount, m_indexType, offset,
+            instanceCount, chunk.baseVertex);
+    else
+        glDrawElementsBaseVertex(m_primitiveType, chunk.indexCount, m_indexType, offset, chunk.baseVertex);
+}
+
+void Mesh::CreatePositionStream() {
+    if (m_positionLayout)
+        return;
+
+    std::vector<glm::vec3> positions(m_vertexVector.size());
+    for (size_t i = 0; i < m_vertexVector.size(); i++)
+        positions[i] = m_vertexVector[i].position;
+
+    m_positionLayout = VertexLayout::Create();
+    m_positionBuffer = Buffer::CreateWithData(GL_ARRAY_BUFFER, GL_STATIC_DRAW,
+        positions.data(), sizeof(glm::vec3), positions.size());
+    m_indexBuffer->Bind(); // element buffer 연결은 VAO에 저장됨
+    m_positionLayout->SetAttrib(0, 3, GL_FLOAT, false, sizeof(glm::vec3), 0);
 }
 
 MeshUPtr Mesh::CreateBox() {
@@ -100,34 +257,35 @@ MeshUPtr Mesh::CreatePlane() {
     return Create(vertices, indices, GL_TRIANGLES);
 }
 
-MeshUPtr Mesh::CreateCylinder(const float radius, const float height, const float rate){
-    std::vector<Vertex> vertices;
-    std::vector<uint32_t> indices;
+void Mesh::GenerateCylinder(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, float radius, float height, float rate) {
+    vertices.clear();
+    indices.clear();
     const int numSlices = 50;
 
-    float textureRadius = 0.218f;
-    float textureIncrement = 0.958f / static_cast<float>(numSlices);
+    float textureRadius = kCylinderCapRadius;
+    float textureIncrement = kCylinderSideWidth / static_cast<float>(numSlices);
+    glm::vec2 capCenter = glm::vec2(kCylinderCapU, kCylinderCapV);
 
     // Create the top cap vertices.
     glm::vec3 topCenter = glm::vec3(0.0f, height / 2.0f, 0.0f);
-    vertices.push_back(Vertex{topCenter, glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(0.717f, 0.740f), glm::vec3(0.0f, 0.0f, 0.0f)});
+    vertices.push_back(Vertex{topCenter, glm::vec3(0.0f, 1.0f, 0.0f), capCenter, glm::vec3(0.0f, 0.0f, 0.0f)});
     float angleIncrement = glm::two_pi<float>() / numSlices;
     float topRadius = radius * rate;
     for (int i = 0; i < numSlices; i++) {
         float angle = angleIncrement * i;
         glm::vec3 pos = glm::vec3(glm::cos(angle) * topRadius, height / 2.0f, glm::sin(angle) * topRadius);
         vertices.push_back(Vertex{pos, glm::vec3(0.0f, 1.0f, 0.0f),
-            glm::vec2(0.717f + textureRadius * glm::cos(angle), 0.740f - textureRadius * glm::sin(angle)), glm::vec3(0.0f, 0.0f, 0.0f)});
+            capCenter + textureRadius * glm::vec2(glm::cos(angle), -glm::sin(angle)), glm::vec3(0.0f, 0.0f, 0.0f)});
     }
 
     // Create the bottom cap vertices.
     glm::vec3 bottomCenter = glm::vec3(0.0f, -height / 2.0f, 0.0f);
-    vertices.push_back(Vertex{bottomCenter, glm::vec3(0.0f, -1.0f, 0.0f), glm::vec2(0.717f, 0.740f), glm::vec3(0.0f, 0.0f, 0.0f)});
+    vertices.push_back(Vertex{bottomCenter, glm::vec3(0.0f, -1.0f, 0.0f), capCenter, glm::vec3(0.0f, 0.0f, 0.0f)});
     for (int i = 0; i < numSlices; i++) {
         float angle = angleIncrement * i;
         glm::vec3 pos = glm::vec3(glm::cos(angle) * radius, -height / 2.0f, glm::sin(angle) * radius);
         vertices.push_back(Vertex{pos, glm::vec3(0.0f, -1.0f, 0.0f),
-            glm::vec2(0.717f + textureRadius * glm::cos(angle), 0.740f - textureRadius * glm::sin(angle)), glm::vec3(0.0f, 0.0f, 0.0f)});
+            capCenter + textureRadius * glm::vec2(glm::cos(angle), -glm::sin(angle)), glm::vec3(0.0f, 0.0f, 0.0f)});
     }
 
     // Create the side vertices.
@@ -136,14 +294,14 @@ MeshUPtr Mesh::CreateCylinder(const float radius, const float height, const floa
         float increment = textureIncrement * i;
         glm::vec3 posTop = glm::vec3(glm::cos(angle) * topRadius, height / 2.0f, glm::sin(angle) * topRadius);
         vertices.push_back(Vertex{posTop, glm::normalize(glm::vec3(glm::cos(angle) * radius, radius / height * (radius - topRadius),
-            glm::sin(angle) * radius)), glm::vec2(0.976f - increment, 0.474f), glm::vec3(0.0f, 0.0f, 0.0f)});
+            glm::sin(angle) * radius)), glm::vec2(kCylinderSideU - increment, kCylinderSideTopV), glm::vec3(0.0f, 0.0f, 0.0f)});
     }
     for (int i = 0; i < numSlices; i++) {
         float angle = angleIncrement * i;
         float increment = textureIncrement * i;
         glm::vec3 posBottom = glm::vec3(glm::cos(angle) * radius, -height / 2.0f, glm::sin(angle) * radius);
         vertices.push_back(Vertex{posBottom, glm::normalize(glm::vec3(glm::cos(angle) * radius, radius / height * (radius - topRadius),
-            glm::sin(angle) * radius)), glm::vec2(0.976f - increment, 0.118f), glm::vec3(0.0f, 0.0f, 0.0f)});
+            glm::sin(angle) * radius)), glm::vec2(kCylinderSideU - increment, kCylinderSideBottomV), glm::vec3(0.0f, 0.0f, 0.0f)});
     }
 
     // Create the top cap indices.
@@ -182,12 +340,17 @@ MeshUPtr Mesh::CreateCylinder(const float radius, const float height, const floa
     indices.push_back(numSlices * 3 + 1);
     indices.push_back(numSlices * 2 + 2);
     indices.push_back(numSlices * 3 + 2);
+}
 
+MeshUPtr Mesh::CreateCylinder(const float radius, const float height, const float rate) {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    GenerateCylinder(vertices, indices, radius, height, rate);
     return Create(vertices, indices, GL_TRIANGLES);
 }
 
-MeshUPtr Mesh::CreateLeaf(float width, float height) {
-    std::vector<Vertex> vertices = {
+void Mesh::GenerateLeaf(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, float width, float height) {
+    vertices = {
         Vertex { glm::vec3( 0.0f,  0.0f, width / 2.0f), glm::vec3( 1.0f,  0.0f, 0.0f), glm::vec2(0.0f, 0.5f), glm::vec3(0.0f, 0.0f, 0.0f) },
         Vertex { glm::vec3( 0.0f,  0.0f, width / -2.0f), glm::vec3( 1.0f,  0.0f, 0.0f), glm::vec2(0.47f, 0.5f), glm::vec3(0.0f, 0.0f, 0.0f) },
         Vertex { glm::vec3( 0.0f,  height, width / -2.0f), glm::vec3( 1.0f,  0.0f, 0.0f), glm::vec2(0.47f, 1.0f), glm::vec3(0.0f, 0.0f, 0.0f) },
@@ -199,17 +362,22 @@ MeshUPtr Mesh::CreateLeaf(float width, float height) {
         Vertex { glm::vec3( 0.0f,  height, width / 2.0f), glm::vec3( -1.0f,  0.0f, 0.0f), glm::vec2(0.0f, 1.0f), glm::vec3(0.0f, 0.0f, 0.0f) },
     };
 
-    std::vector<uint32_t> indices = {
+    indices = {
         0, 1, 2, 2, 3, 0,
         4, 7, 5, 5, 7, 6
     };
-
-    return Create(vertices, indices, GL_TRIANGLES);
 }
 
-MeshUPtr Mesh::CreateSphere(float radius) {
+MeshUPtr Mesh::CreateLeaf(float width, float height) {
     std::vector<Vertex> vertices;
     std::vector<uint32_t> indices;
+    GenerateLeaf(vertices, indices, width, height);
+    return Create(vertices, indices, GL_TRIANGLES);
+}
+
+void Mesh::GenerateSphere(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, float radius) {
+    vertices.clear();
+    indices.clear();
 
     const int stacks = 15;
     const int slices = 30;
@@ -243,7 +411,12 @@ MeshUPtr Mesh::CreateSphere(float radius) {
             indices.push_back(currRow + j);
         }
     }
+}
 
+MeshUPtr Mesh::CreateSphere(float radius) {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    GenerateSphere(vertices, indices, radius);
     return Create(vertices, indices, GL_TRIANGLES);
 }
 
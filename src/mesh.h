@@ -6,6 +6,7 @@
 #include "vertex_layout.h"
 #include "texture.h"
 #include "program.h"
+#include "bounds.h"
 
 struct Vertex {
     glm::vec3 position;
@@ -33,8 +34,34 @@ private:
 CLASS_PTR(Mesh);
 class Mesh {
 public:
+    /*
+    16bit index로 그리는 단위, 모든 chunk가 mesh의 vertex, index buffer 하나를 나눠 씀
+    vertex가 kMaxChunkVertices개를 넘는 삼각형 mesh는 가까운 삼각형끼리 여러 chunk로 나누고
+    chunk 안의 index는 baseVertex부터 센 번호 (glDrawElementsBaseVertex)
+    */
+    struct Chunk {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        int32_t baseVertex;
+        uint32_t vertexCount;
+        AABB bounds;
+    };
+    static constexpr size_t kMaxChunkVertices = 0x10000;
+
+    // tree.png에서 원기둥이 쓰는 영역, 옆면은 u를 한 바퀴 돌고 뚜껑은 원 모양
+    static constexpr float kCylinderSideU = 0.976f;
+    static constexpr float kCylinderSideWidth = 0.958f;
+    static constexpr float kCylinderSideBottomV = 0.118f;
+    static constexpr float kCylinderSideTopV = 0.474f;
+    static constexpr float kCylinderCapU = 0.717f;
+    static constexpr float kCylinderCapV = 0.740f;
+    static constexpr float kCylinderCapRadius = 0.218f;
+
     static MeshUPtr Create(const std::vector<Vertex>& vertices,
         const std::vector<uint32_t>& indices,uint32_t primitiveType);
+    // tangent와 bounds가 이미 계산된 데이터를 그대로 올림 (mesh cache 등에서 map한 메모리)
+    static MeshUPtr CreateFromData(const Vertex* vertices, size_t vertexCount,
+        const uint32_t* indices, size_t indexCount, uint32_t primitiveType, const AABB& bounds);
 
     static MeshUPtr CreateBox();
     static MeshUPtr CreatePlane();
@@ -43,34 +70,65 @@ public:
     static MeshUPtr CreateSphere(float radius = 0.1f);
     static MeshUPtr CreateLsysLeaf(float width = 0.02f, float height = 0.1f);
 
+    // GL 객체 없이 CPU 쪽 vertex, index만 만듦 (tangent는 비어 있음), 창 없이 export할 때 사용
+    static void GenerateCylinder(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+        float radius, float height, float rate);
+    static void GenerateLeaf(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, float width, float height);
+    static void GenerateSphere(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, float radius);
+
     const VertexLayout* GetVertexLayout() const { return m_vertexLayout.get(); }
     BufferPtr GetVertexBuffer() const { return m_vertexBuffer; }
     BufferPtr GetIndexBuffer() const { return m_indexBuffer; }
 
+    const AABB& GetBounds() const { return m_bounds; }
+
     void SetMaterial(MaterialPtr material) { m_material = material; }
     MaterialPtr GetMaterial() const { return m_material; }
 
+    const std::vector<Chunk>& GetChunks() const { return m_chunks; }
+
     void Draw(const Program* program) const;
+    // instanceBuffer의 offset부터 mat4 instanceCount개를 location 4~7에 연결해서 그림
+    // positionOnly면 위치만 빽빽하게 담은 별도의 vertex stream 사용 (CreatePositionStream 필요)
+    // chunk가 0 이상이면 그 chunk만 그림
+    void DrawInstanced(const Buffer* instanceBuffer, uint64_t offset, uint32_t instanceCount,
+        bool positionOnly = false, int chunk = -1) const;
+
+    // depth pass용 위치 전용 vertex buffer와 layout 생성, index buffer는 공유
+    void CreatePositionStream();
+    bool HasPositionStream() const { return m_positionLayout != nullptr; }
 
     static void ComputeTangents(std::vector<Vertex>& vertices,
         const std::vector<uint32_t>& indices);
 
-    std::vector<Vertex> GetVertexVector() { return m_vertexVector; }
-    std::vector<int> GetIndexVector() { return m_indexVector; }
+    const std::vector<Vertex>& GetVertexVector() const { return m_vertexVector; }
+    // chunk로 나눴으면 나눈 뒤의 순서, index는 vertex 배열 전체 기준
+    const std::vector<uint32_t>& GetIndexVector() const { return m_indexVector; }
 
 private:
     Mesh() {}
     void Init(const std::vector<Vertex>& vertices,
         const std::vector<uint32_t>& indices, uint32_t primitiveType);
+    void InitBuffers(const Vertex* vertices, size_t vertexCount,
+        const uint32_t* indices, size_t indexCount);
+    // 큰 삼각형 mesh를 chunk로 나눠 m_vertexVector, m_indexVector, m_chunks를 채우고 chunk 기준 index를 돌려줌
+    std::vector<uint16_t> BuildChunks(const Vertex* vertices, size_t vertexCount,
+        const uint32_t* indices, size_t indexCount);
+    void DrawChunk(const Chunk& chunk, uint32_t instanceCount) const;
 
     uint32_t m_primitiveType { GL_TRIANGLES };
     VertexLayoutUPtr m_vertexLayout;
     BufferPtr m_vertexBuffer;
     BufferPtr m_indexBuffer;
+    uint32_t m_indexType { GL_UNSIGNED_SHORT };
+    std::vector<Chunk> m_chunks;
+    VertexLayoutUPtr m_positionLayout;
+    BufferPtr m_positionBuffer;
 
     MaterialPtr m_material;
+    AABB m_bounds;
     std::vector<Vertex> m_vertexVector;
-    std::vector<int> m_indexVector;
+    std::vector<uint32_t> m_indexVector;
     int m_numSlices = 50;
 };
 
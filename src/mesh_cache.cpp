@@ -0,0 +1,255 @@
+#include "mesh_cache.h"
+#include <algorithm>
+#include <filesystem>
+
+namespace {
+    bool s_enabled = true;
+    const char* kCacheDir = "./cache";
+    const uint32_t kMagic = 0x434d4754; // "TGMC"
+    const uint32_t kVersion = 1;
+    const uint64_t kDataAlignment = 16;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vertexSize;
+        uint32_t meshCount;
+        uint32_t materialCount;
+        uint32_t reserved;
+        uint64_t sourceSize;
+        int64_t sourceTime;
+        uint64_t stringOffset;
+        uint64_t stringSize;
+    };
+
+    struct MeshEntry {
+        uint64_t vertexOffset;
+        uint64_t indexOffset;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        int32_t materialIndex;
+        float boundsMin[3];
+        float boundsMax[3];
+        uint32_t reserved;
+    };
+
+    // 원본의 절대 경로, 크기, 수정 시각
+    struct SourceInfo {
+        std::string path;
+        uint64_t size { 0 };
+        int64_t time { 0 };
+    };
+
+    bool GetSourceInfo(const std::string& sourcePath, SourceInfo& info) {
+        std::error_code error;
+        auto path = std::filesystem::absolute(sourcePath, error);
+        if (error)
+            return false;
+        info.path = path.lexically_normal().generic_string();
+        info.size = (uint64_t)std::filesystem::file_size(path, error);
+        if (error)
+            return false;
+        info.time = (int64_t)std::filesystem::last_write_time(path, error).time_since_epoch().count();
+        return !error;
+    }
+
+    std::string GetCachePath(const SourceInfo& info) {
+        // 64bit FNV-1a
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (unsigned char c : info.path) {
+            hash ^= c;
+            hash *= 0x100000001b3ull;
+        }
+        return fmt::format("{}/{:016x}.mesh", kCacheDir, hash);
+    }
+
+    uint64_t Align(uint64_t offset) {
+        return (offset + kDataAlignment - 1) & ~(kDataAlignment - 1);
+    }
+
+    void AppendString(std::string& block, const std::string& text) {
+        uint32_t length = (uint32_t)text.size();
+        block.append((const char*)&length, sizeof(length));
+        block.append(text);
+    }
+
+    bool ReadString(const uint8_t*& p, const uint8_t* end, std::string& text) {
+        uint32_t length = 0;
+        if ((size_t)(end - p) < sizeof(length))
+            return false;
+        memcpy(&length, p, sizeof(length));
+        p += sizeof(length);
+        if ((size_t)(end - p) < length)
+            return false;
+        text.assign((const char*)p, length);
+        p += length;
+        return true;
+    }
+}
+
+void MeshCache::SetEnabled(bool enabled) {
+    s_enabled = enabled;
+}
+
+MeshCacheUPtr MeshCache::Open(const std::string& sourcePath) {
+    if (!s_enabled)
+        return nullptr;
+    auto cache = MeshCacheUPtr(new MeshCache());
+    if (!cache->Load(sourcePath))
+        return nullptr;
+    return std::move(cache);
+}
+
+/*
+파일 구성
+Header, MeshEntry * meshCount
+string block: 원본 절대 경로, material마다 (이름, diffuse, specular), 각각 uint32 길이 + 문자열
+mesh마다 Vertex 배열, uint32 index 배열 (16byte 정렬)
+*/
+bool MeshCache::Load(const std::string& sourcePath) {
+    SourceInfo info;
+    if (!GetSourceInfo(sourcePath, info))
+        return false;
+    auto cachePath = GetCachePath(info);
+    if (!std::filesystem::exists(cachePath))
+        return false;
+
+    m_file = MappedFile::Open(cachePath);
+    if (!m_file)
+        return false;
+    const uint8_t* data = m_file->GetData();
+    uint64_t size = m_file->GetSize();
+
+    Header header;
+    if (size < sizeof(Header))
+        return false;
+    memcpy(&header, data, sizeof(Header));
+    if (header.magic != kMagic || header.version != kVersion || header.vertexSize != sizeof(Vertex))
+        return false;
+    if (header.sourceSize != info.size || header.sourceTime != info.time)
+        return false;
+    if ((uint64_t)header.meshCount * sizeof(MeshEntry) > size - sizeof(Header) ||
+        header.stringOffset > size || header.stringSize > size - header.stringOffset)
+        return false;
+
+    // hash가 겹친 다른 파일의 cache인지 확인
+    const uint8_t* p = data + header.stringOffset;
+    const uint8_t* stringEnd = p + header.stringSize;
+    std::string path;
+    if (!ReadString(p, stringEnd, path) || path != info.path)
+        return false;
+    // material마다 문자열 세 개, 각각 적어도 길이 4byte가 있어야 하므로 개수부터 확인 (잘못된 파일로 큰 할당을 하지 않도록)
+    if ((uint64_t)header.materialCount * 3 * sizeof(uint32_t) > (uint64_t)(stringEnd - p))
+        return false;
+    m_materials.resize(header.materialCount);
+    for (auto& material : m_materials) {
+        if (!ReadString(p, stringEnd, material.name) ||
+            !ReadString(p, stringEnd, material.diffuseTexture) ||
+            !ReadString(p, stringEnd, material.specularTexture))
+            return false;
+    }
+
+    const MeshEntry* entries = (const MeshEntry*)(data + sizeof(Header));
+    m_meshes.resize(header.meshCount);
+    for (uint32_t i = 0; i < header.meshCount; i++) {
+        MeshEntry entry;
+        memcpy(&entry, &entries[i], sizeof(MeshEntry));
+        uint64_t vertexBytes = (uint64_t)entry.vertexCount * sizeof(Vertex);
+        uint64_t indexBytes = (uint64_t)entry.indexCount * sizeof(uint32_t);
+        if (entry.vertexOffset % kDataAlignment || entry.indexOffset % kDataAlignment ||
+            entry.vertexOffset > size || vertexBytes > size - entry.vertexOffset ||
+            entry.indexOffset > size || indexBytes > size - entry.indexOffset ||
+            entry.materialIndex >= (int32_t)header.materialCount)
+            return false;
+
+        // 잘못된 index로 GPU가 범위 밖을 읽지 않도록 확인, 실패하면 원본을 다시 읽음
+        const uint32_t* indices = (const uint32_t*)(data + entry.indexOffset);
+        if (!std::all_of(indices, indices + entry.indexCount,
+            [&entry](uint32_t index) { return index < entry.vertexCount; }))
+            return false;
+
+        auto& mesh = m_meshes[i];
+        mesh.vertices = (const Vertex*)(data + entry.vertexOffset);
+        mesh.vertexCount = entry.vertexCount;
+        mesh.indices = indices;
+        mesh.indexCount = entry.indexCount;
+        mesh.materialIndex = entry.materialIndex;
+        mesh.bounds.min = glm::vec3(entry.boundsMin[0], entry.boundsMin[1], entry.boundsMin[2]);
+        mesh.bounds.max = glm::vec3(entry.boundsMax[0], entry.boundsMax[1], entry.boundsMax[2]);
+    }
+    return true;
+}
+
+bool MeshCache::Write(const std::string& sourcePath, const ModelData& data, ModelLoadProgress* progress) {
+    if (!s_enabled)
+        return false;
+    SourceInfo info;
+    if (!GetSourceInfo(sourcePath, info))
+        return false;
+
+    std::string strings;
+    AppendString(strings, info.path);
+    for (auto& material : data.materials) {
+        AppendString(strings, material.name);
+        AppendString(strings, material.diffuseTexture);
+        AppendString(strings, material.specularTexture);
+    }
+
+    Header header = {};
+    header.magic = kMagic;
+    header.version = kVersion;
+    header.vertexSize = sizeof(Vertex);
+    header.meshCount = (uint32_t)data.meshes.size();
+    header.materialCount = (uint32_t)data.materials.size();
+    header.sourceSize = info.size;
+    header.sourceTime = info.time;
+    header.stringOffset = sizeof(Header) + sizeof(MeshEntry) * data.meshes.size();
+    header.stringSize = strings.size();
+
+    std::vector<MeshEntry> entries(data.meshes.size());
+    uint64_t offset = Align(header.stringOffset + header.stringSize);
+    for (size_t i = 0; i < data.meshes.size(); i++) {
+        auto& mesh = data.meshes[i];
+        auto& entry = entries[i];
+        entry = {};
+        entry.vertexCount = (uint32_t)mesh.vertices.size();
+        entry.indexCount = (uint32_t)mesh.indices.size();
+        entry.materialIndex = mesh.materialIndex;
+        for (int k = 0; k < 3; k++) {
+            entry.boundsMin[k] = mesh.bounds.min[k];
+            entry.boundsMax[k] = mesh.bounds.max[k];
+        }
+        entry.vertexOffset = offset;
+        offset = Align(offset + mesh.vertices.size() * sizeof(Vertex));
+        entry.indexOffset = offset;
+        offset = Align(offset + mesh.indices.size() * sizeof(uint32_t));
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(kCacheDir, error);
+    auto cachePath = GetCachePath(info);
+    // 쓰는 도중에 다른 곳에서 읽지 않도록 임시 파일에 다 쓴 뒤 이름을 바꿈, 취소되면 쓰던 파일은 지움
+    return WriteFileAtomic(cachePath, true, [&](std::ostream& out) {
+        const char padding[kDataAlignment] = {};
+        auto Pad = [&out, &padding]() {
+            uint64_t position = (uint64_t)out.tellp();
+            out.write(padding, Align(position) - position);
+        };
+
+        out.write((const char*)&header, sizeof(header));
+        out.write((const char*)entries.data(), sizeof(MeshEntry) * entries.size());
+        out.write(strings.data(), strings.size());
+        Pad();
+        for (auto& mesh : data.meshes) {
+            if (progress && progress->canceled)
+                return false;
+            out.write((const char*)mesh.vertices.data(), sizeof(Vertex) * mesh.vertices.size());
+            Pad();
+            out.write((const char*)mesh.indices.data(), sizeof(uint32_t) * mesh.indices.size());
+            Pad();
+        }
+        if (!out)
+            SPDLOG_ERROR("failed to write mesh cache: {}", cachePath);
+        return (bool)out;
+    });
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#ifndef __MESH_CACHE_H__
+#define __MESH_CACHE_H__
+
+#include "common.h"
+#include "mapped_file.h"
+#include "obj_loader.h"
+
+/*
+한 번 읽은 모델의 vertex / index 배열, material, bounds를 ./cache에 그대로 저장해둔 파일
+원본 경로의 hash로 파일을 찾고 원본의 크기, 수정 시각이 같을 때만 사용
+파일을 map해서 vertex 배열을 가공 없이 바로 GL buffer로 올림
+*/
+CLASS_PTR(MeshCache)
+class MeshCache {
+public:
+    // map된 파일 안을 가리키므로 MeshCache가 살아있는 동안만 유효
+    struct MeshView {
+        const Vertex* vertices { nullptr };
+        uint32_t vertexCount { 0 };
+        const uint32_t* indices { nullptr };
+        uint32_t indexCount { 0 };
+        int materialIndex { -1 };
+        AABB bounds;
+    };
+
+    // cache가 없거나 원본과 맞지 않으면 nullptr
+    static MeshCacheUPtr Open(const std::string& sourcePath);
+    // data의 tangent, bounds는 이미 계산되어 있어야 함
+    // progress로 취소되면 쓰던 파일을 지우고 false
+    static bool Write(const std::string& sourcePath, const ModelData& data, ModelLoadProgress* progress = nullptr);
+    static void SetEnabled(bool enabled);
+
+    const std::vector<MeshView>& GetMeshes() const { return m_meshes; }
+    const std::vector<ModelData::MaterialData>& GetMaterials() const { return m_materials; }
+
+private:
+    MeshCache() {}
+    bool Load(const std::string& sourcePath);
+
+    MappedFileUPtr m_file;
+    std::vector<MeshView> m_meshes;
+    std::vector<ModelData::MaterialData> m_materials;
+};
+
+#endif // __MESH_CACHE_H__
\ No newline at end of file
@@ -1,63 +1,217 @@
 #include "model.h"
+#include "mesh_cache.h"
+#include <algorithm>
+#include <chrono>
 
-ModelUPtr Model::Load(const std::string& filename) {
+ModelUPtr Model::Load(const std::string& filename, ResourceManager* resources) {
+    ThreadPool* pool = resources ? resources->GetLoader()->GetThreadPool() : nullptr;
+    ModelSource source;
+    if (!LoadSource(filename, source, pool))
+        return nullptr;
+    return CreateFromSource(filename, source, resources);
+}
+
+bool Model::LoadSource(const std::string& filename, ModelSource& source, ThreadPool* pool,
+    ModelLoadProgress* progress) {
+    auto startTime = std::chrono::steady_clock::now();
+    auto LogTime = [&startTime, &filename](const char* from) {
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime);
+        SPDLOG_INFO("model loaded ({}) in {:.1f} ms: {}", from, elapsed.count(), filename);
+    };
+    auto IsCanceled = [progress]() { return progress && progress->canceled; };
+
+    source.cache = MeshCache::Open(filename);
+    if (source.cache) {
+        if (progress)
+            progress->progress = 1.0f;
+        LogTime("cache");
+        return true;
+    }
+
+    auto& data = source.data;
+    bool loaded = false;
+    const char* from = "obj";
+    auto extension = filename.substr(std::min(filename.rfind('.'), filename.size()));
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == ".obj") {
+        loaded = LoadObj(filename, data, pool, progress);
+        if (IsCanceled())
+            return false;
+        if (!loaded)
+            SPDLOG_INFO("fall back to assimp: {}", filename);
+    }
+    if (!loaded) {
+        data = ModelData();
+        if (!LoadByAssimp(filename, data, progress))
+            return false;
+        from = "assimp";
+    }
+
+    PrepareData(data, pool, progress);
+    if (IsCanceled())
+        return false;
+    MeshCache::Write(filename, data, progress);
+    if (IsCanceled())
+        return false;
+    if (progress)
+        progress->progress = 1.0f;
+    LogTime(from);
+    return true;
+}
+
+ModelUPtr Model::CreateFromSource(const std::string& filename, const ModelSource& source,
+    ResourceManager* resources) {
     auto model = ModelUPtr(new Model());
-    if (!model->LoadByAssimp(filename))
+    bool created = source.cache ?
+        model->InitFromCache(filename, source.cache.get(), resources) :
+        model->InitFromData(filename, source.data, resources);
+    if (!created)
         return nullptr;
     return std::move(model);
 }
 
-bool Model::LoadByAssimp(const std::string& filename) {
+// mesh마다 tangent와 bounds 계산, cache에 저장된 데이터는 이 과정을 거치지 않음
+void Model::PrepareData(ModelData& data, ThreadPool* pool, ModelLoadProgress* progress) {
+    auto Prepare = [&data, progress](size_t i) {
+        if (progress && progress->canceled)
+            return;
+        auto& mesh = data.meshes[i];
+        Mesh::ComputeTangents(mesh.vertices, mesh.indices);
+        mesh.bounds = AABB();
+        for (const auto& vertex : mesh.vertices)
+            mesh.bounds.Expand(vertex.position);
+    };
+    if (pool) {
+        pool->ParallelFor(data.meshes.size(), Prepare);
+        return;
+    }
+    for (size_t i = 0; i < data.meshes.size(); i++)
+        Prepare(i);
+}
+
+bool Model::InitFromData(const std::string& filename, const ModelData& data, ResourceManager* resources) {
+    InitMaterials(filename, data.materials, resources);
+    for (auto& mesh : data.meshes) {
+        SPDLOG_INFO("Process mesh: #vert: {}, #face: {}", mesh.vertices.size(), mesh.indices.size() / 3);
+        auto glMesh = Mesh::CreateFromData(mesh.vertices.data(), mesh.vertices.size(),
+            mesh.indices.data(), mesh.indices.size(), GL_TRIANGLES, mesh.bounds);
+        if (!glMesh)
+            return false;
+        if (mesh.materialIndex >= 0 && mesh.materialIndex < (int)m_materials.size())
+            glMesh->SetMaterial(m_materials[mesh.materialIndex]);
+        m_meshes.push_back(std::move(glMesh));
+    }
+    return true;
+}
+
+bool Model::InitFromCache(const std::string& filename, const MeshCache* cache, ResourceManager* resources) {
+    InitMaterials(filename, cache->GetMaterials(), resources);
+    for (auto& mesh : cache->GetMeshes()) {
+        auto glMesh = Mesh::CreateFromData(mesh.vertices, mesh.vertexCount,
+            mesh.indices, mesh.indexCount, GL_TRIANGLES, mesh.bounds);
+        if (!glMesh)
+            return false;
+        if (mesh.materialIndex >= 0)
+            glMesh->SetMaterial(m_materials[mesh.materialIndex]);
+        m_meshes.push_back(std::move(glMesh));
+    }
+    return true;
+}
+
+void Model::InitMaterials(const std::string& filename,
+    const std::vector<ModelData::MaterialData>& materials, ResourceManager* resources) {
+    auto dirname = filename.substr(0, filename.find_last_of("/\\"));
+    for (auto& material : materials) {
+        auto glMaterial = Material::Create();
+        if (!material.diffuseTexture.empty())
+            glMaterial->diffuse = LoadMaterialTexture(dirname, material.diffuseTexture, resources);
+        if (!material.specularTexture.empty())
+            glMaterial->specular = LoadMaterialTexture(dirname, material.specularTexture, resources);
+        m_materials.push_back(std::move(glMaterial));
+    }
+}
+
+TexturePtr Model::LoadMaterialTexture(const std::string& dirname, const std::string& filepath,
+    ResourceManager* resources) {
+    auto texturePath = fmt::format("{}/{}", dirname, filepath);
+    if (resources)
+        return resources->GetTexture(texturePath);
+    auto image = Image::Load(texturePath);
+    if (!image)
+        return nullptr;
+    return Texture::CreateFromImage(image.get());
+}
+
+namespace {
+    // assimp import 진행률을 ModelLoadProgress로 전달, 취소되면 false를 돌려줘서 import 중단
+    class AssimpProgressHandler : public Assimp::ProgressHandler {
+    public:
+        AssimpProgressHandler(ModelLoadProgress* progress) : m_progress(progress) {}
+        bool Update(float percentage) override {
+            if (percentage >= 0.0f)
+                m_progress->progress = percentage;
+            return !m_progress->canceled;
+        }
+
+    private:
+        ModelLoadProgress* m_progress;
+    };
+}
+
+bool Model::LoadByAssimp(const std::string& filename, ModelData& data, ModelLoadProgress* progress) {
     Assimp::Importer importer;
+    // importer가 handler를 소유하고 소멸할 때 지움
+    if (progress)
+        importer.SetProgressHandler(new AssimpProgressHandler(progress));
     auto scene = importer.ReadFile(filename, aiProcess_Triangulate | aiProcess_FlipUVs);
+    if (progress && progress->canceled)
+        return false;
 
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
         SPDLOG_ERROR("failed to load model: {}", filename);
         return false;
     }
 
-    auto dirname = filename.substr(0, filename.find_last_of("/"));
-    auto LoadTexture = [&](aiMaterial* material, aiTextureType type) -> TexturePtr {
+    auto GetTexturePath = [](aiMaterial* material, aiTextureType type) -> std::string {
         if (material->GetTextureCount(type) <= 0)
-            return nullptr;
+            return std::string();
         aiString filepath;
         material->GetTexture(type, 0, &filepath);
-        auto image = Image::Load(fmt::format("{}/{}", dirname, filepath.C_Str()));
-        if (!image)
-            return nullptr;
-        return Texture::CreateFromImage(image.get());
+        return filepath.C_Str();
     };
 
     for (uint32_t i = 0; i < scene->mNumMaterials; i++) {
         auto material = scene->mMaterials[i];
-        auto glMaterial = Material::Create();
-        glMaterial->diffuse = LoadTexture(material, aiTextureType_DIFFUSE);
-        glMaterial->specular = LoadTexture(material, aiTextureType_SPECULAR);
-        m_materials.push_back(std::move(glMaterial));
+        ModelData::MaterialData materialData;
+        materialData.name = material->GetName().C_Str();
+        materialData.diffuseTexture = GetTexturePath(material, aiTextureType_DIFFUSE);
+        materialData.specularTexture = GetTexturePath(material, aiTextureType_SPECULAR);
+        data.materials.push_back(std::move(materialData));
     }
 
-    ProcessNode(scene->mRootNode, scene);
+    ProcessNode(scene->mRootNode, scene, data);
     return true;
 }
 
 // tree 형식으로 구현
-void Model::ProcessNode(aiNode* node, const aiScene* scene) {
+void Model::ProcessNode(aiNode* node, const aiScene* scene, ModelData& data) {
     for (uint32_t i = 0; i < node->mNumMeshes; i++) {
         auto meshIndex = node->mMeshes[i];
         auto mesh = scene->mMeshes[meshIndex];
-        ProcessMesh(mesh, scene);
+        ProcessMesh(mesh, scene, data);
     }
 
     for (uint32_t i = 0; i < node->mNumChildren; i++) {
-        ProcessNode(node->mChildren[i], scene);
+        ProcessNode(node->mChildren[i], scene, data);
     }
 }
 
-void Model::ProcessMesh(aiMesh* mesh, const aiScene* scene) {
+void Model::ProcessMesh(aiMesh* mesh, const aiScene* scene, ModelData& data) {
     SPDLOG_INFO("Process mesh: {}, #vert: {}, #face: {}",
         mesh->mName.C_Str(), mesh->mNumVertices, mesh->mNumFaces);
 
-    std::vector<Vertex> vertices;
+    ModelData::MeshData meshData;
+    auto& vertices = meshData.vertices;
     vertices.resize(mesh->mNumVertices);
     for (uint32_t i = 0; i < mesh->mNumVertices; i++) {
         auto& v = vertices[i];
@@ -66,7 +220,7 @@ void Model::ProcessMesh(aiMesh* mesh, const aiScene* scene) {
         v.texCoord = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
     }
 
-    std::vector<uint32_t> indices;
+    auto& indices = meshData.indices;
     indices.resize(mesh->mNumFaces * 3);
     for (uint32_t i = 0; i < mesh->mNumFaces; i++) {
         indices[3*i  ] = mesh->mFaces[i].mIndices[0];
@@ -74,15 +228,35 @@ void Model::ProcessMesh(aiMesh* mesh, const aiScene* scene) {
         indices[3*i+2] = mesh->mFaces[i].mIndices[2];
     }
 
-    auto glMesh = Mesh::Create(vertices, indices, GL_TRIANGLES);
-    if (mesh->mMaterialIndex >= 0)
-        glMesh->SetMaterial(m_materials[mesh->mMaterialIndex]);
-    
-    m_meshes.push_back(std::move(glMesh));
+    meshData.materialIndex = (int)mesh->mMaterialIndex;
+    data.meshes.push_back(std::move(meshData));
+}
+
+AABB Model::GetBounds() const {
+    AABB bounds;
+    for (auto& mesh: m_meshes)
+        bounds.Expand(mesh->GetBounds());
+    return bounds;
 }
 
-void Model::Draw(const Program* program) const {
+void Model::Submit(DrawList* drawList, RenderPass pass, const Program* program,
+    const glm::mat4& modelTransform, const Material* fallbackMaterial, const Frustum* frustum) const {
+    std::vector<int> visible;
     for (auto& mesh: m_meshes) {
-        mesh->Draw(program);
+        auto material = mesh->GetMaterial();
+        const Material* drawMaterial = (material && material->diffuse) ? material.get() : fallbackMaterial;
+        const auto& chunks = mesh->GetChunks();
+        visible.clear();
+        for (int i = 0; frustum && i < (int)chunks.size(); i++) {
+            if (frustum->Test(chunks[i].bounds.Transform(modelTransform)) != Frustum::OUTSIDE)
+                visible.push_back(i);
+        }
+        // 모두 보이면 mesh 전체를 한 번에 제출
+        if (!frustum || visible.size() == chunks.size()) {
+            drawList->Submit(pass, mesh.get(), program, drawMaterial, modelTransform);
+            continue;
+        }
+        for (int chunk : visible)
+            drawList->Submit(pass, mesh.get(), program, drawMaterial, modelTransform, false, chunk);
     }
 }
\ No newline at end of file
@@ -3,26 +3,62 @@
 
 #include "common.h"
 #include "mesh.h"
+#include "draw_list.h"
+#include "resource_manager.h"
+#include "obj_loader.h"
+#include "mesh_cache.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <assimp/ProgressHandler.hpp>
+
+// GL 객체를 만들기 전까지의 모델 (parse 결과나 map된 mesh cache 중 하나)
+struct ModelSource {
+    MeshCacheUPtr cache;
+    ModelData data;
+};
 
 CLASS_PTR(Model);
 class Model {
 public:
-    static ModelUPtr Load(const std::string& filename);
+    // resources가 있으면 material texture를 다른 모델과 공유
+    // .obj는 자체 loader로 먼저 읽고 실패하거나 다른 형식이면 assimp 사용
+    // 한 번 읽은 모델은 mesh cache에 저장해두고 원본이 바뀌지 않았으면 cache에서 바로 올림
+    static ModelUPtr Load(const std::string& filename, ResourceManager* resources = nullptr);
+    // Load를 두 단계로 나눈 것, LoadSource는 GL을 쓰지 않으므로 worker thread에서 호출 가능
+    // 실패하거나 progress로 취소되면 false
+    static bool LoadSource(const std::string& filename, ModelSource& source, ThreadPool* pool,
+        ModelLoadProgress* progress = nullptr);
+    // main thread에서 호출
+    static ModelUPtr CreateFromSource(const std::string& filename, const ModelSource& source,
+        ResourceManager* resources);
 
     int GetMeshCount() const { return (int)m_meshes.size(); }
     MeshPtr GetMesh(int index) const { return m_meshes[index]; }
-    void Draw(const Program* program) const;
+    // 모든 mesh를 감싸는 local space bounds
+    AABB GetBounds() const;
+    // mesh에 diffuse texture가 없으면 fallbackMaterial 사용
+    // frustum이 있으면 chunk 단위로 culling해서 보이는 chunk만 제출
+    void Submit(DrawList* drawList, RenderPass pass, const Program* program,
+        const glm::mat4& modelTransform, const Material* fallbackMaterial = nullptr,
+        const Frustum* frustum = nullptr) const;
 
 private:
     Model() {}
-    bool LoadByAssimp(const std::string& filename);
-    void ProcessMesh(aiMesh* mesh, const aiScene* scene);
-    void ProcessNode(aiNode* node, const aiScene* scene);
-        
+    static bool LoadByAssimp(const std::string& filename, ModelData& data, ModelLoadProgress* progress);
+    static void ProcessMesh(aiMesh* mesh, const aiScene* scene, ModelData& data);
+    static void ProcessNode(aiNode* node, const aiScene* scene, ModelData& data);
+    // 취소되면 남은 mesh는 건너뜀
+    static void PrepareData(ModelData& data, ThreadPool* pool, ModelLoadProgress* progress = nullptr);
+
+    bool InitFromData(const std::string& filename, const ModelData& data, ResourceManager* resources);
+    bool InitFromCache(const std::string& filename, const MeshCache* cache, ResourceManager* resources);
+    void InitMaterials(const std::string& filename,
+        const std::vector<ModelData::MaterialData>& materials, ResourceManager* resources);
+    static TexturePtr LoadMaterialTexture(const std::string& dirname, const std::string& filepath,
+        ResourceManager* resources);
+
     std::vector<MeshPtr> m_meshes;
     std::vector<MaterialPtr> m_materials;
 };
@@ -0,0 +1,35 @@
+#include "model_loader.h"
+
+ModelLoaderUPtr ModelLoader::Create(const std::string& filename, ThreadPool* pool) {
+    auto loader = ModelLoaderUPtr(new ModelLoader());
+    loader->Start(filename, pool);
+    return std::move(loader);
+}
+
+ModelLoader::~ModelLoader() {
+    Cancel();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void ModelLoader::Start(const std::string& filename, ThreadPool* pool) {
+    m_filename = filename;
+    m_thread = std::thread([this, pool]() {
+        m_succeeded = Model::LoadSource(m_filename, m_source, pool, &m_progress);
+        m_finished = true;
+    });
+}
+
+ModelUPtr ModelLoader::CreateModel(ResourceManager* resources) {
+    if (!m_finished)
+        return nullptr;
+    if (m_thread.joinable())
+        m_thread.join();
+    if (!m_succeeded || m_progress.canceled)
+        return nullptr;
+
+    auto model = Model::CreateFromSource(m_filename, m_source, resources);
+    // map된 cache와 CPU 쪽 배열은 GL buffer로 올린 뒤 필요 없음
+    m_source = ModelSource();
+    return std::move(model);
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef __MODEL_LOADER_H__
+#define __MODEL_LOADER_H__
+
+#include "common.h"
+#include "model.h"
+#include <thread>
+
+/*
+모델 하나를 별도 thread에서 읽는 작업
+parse는 worker에서, GL 객체는 IsFinished 이후 main thread의 CreateModel에서 만듦
+소멸 시 취소를 요청하고 worker가 끝날 때까지 기다림
+*/
+CLASS_PTR(ModelLoader)
+class ModelLoader {
+public:
+    // pool은 obj parse에 같이 사용 (nullptr이면 loader thread 혼자 처리)
+    static ModelLoaderUPtr Create(const std::string& filename, ThreadPool* pool = nullptr);
+    ~ModelLoader();
+
+    const std::string& GetFilename() const { return m_filename; }
+    float GetProgress() const { return m_progress.progress; }
+    bool IsFinished() const { return m_finished; }
+    bool IsCanceled() const { return m_progress.canceled; }
+    void Cancel() { m_progress.canceled = true; }
+
+    // IsFinished 이후 main thread에서 호출, 실패하거나 취소되었으면 nullptr
+    ModelUPtr CreateModel(ResourceManager* resources);
+
+private:
+    ModelLoader() {}
+    void Start(const std::string& filename, ThreadPool* pool);
+
+    std::string m_filename;
+    ModelSource m_source;
+    ModelLoadProgress m_progress;
+    std::atomic<bool> m_finished { false };
+    bool m_succeeded { false }; // m_finished가 true가 된 뒤에만 읽음
+    std::thread m_thread;
+};
+
+#endif // __MODEL_LOADER_H__
\ No newline at end of file
@@ -0,0 +1,465 @@
+#include "obj_loader.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace {
+    // 이보다 작은 파일은 chunk를 나누지 않음
+    const size_t kMinChunkSize = 1 << 20;
+    // 이만큼 parse할 때마다 진행률 갱신, 취소 확인
+    const size_t kProgressInterval = 1 << 18;
+    // parse가 전체 진행률에서 차지하는 비율, 나머지는 vertex 구성
+    const float kParseProgress = 0.8f;
+    const int32_t kMissing = -1;
+
+    enum RelativeBit : uint8_t {
+        RELATIVE_V = 1,
+        RELATIVE_VT = 2,
+        RELATIVE_VN = 4,
+    };
+
+    /*
+    면의 꼭짓점 하나의 v/vt/vn 번호, 0부터 시작
+    음수 번호(상대 참조)는 chunk 시작 기준 번호로 저장하고 relative에 표시해뒀다가
+    chunk들의 시작 번호가 정해진 뒤 Resolve에서 전체 번호로 바꿈 (앞 chunk를 가리키면 음수일 수 있음)
+    */
+    struct Corner {
+        int32_t v { kMissing };
+        int32_t vt { kMissing };
+        int32_t vn { kMissing };
+        uint8_t relative { 0 };
+    };
+
+    struct Chunk {
+        const char* begin { nullptr };
+        const char* end { nullptr };
+
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec2> texCoords;
+        std::vector<glm::vec3> normals;
+        std::vector<Corner> corners; // 삼각형마다 3개
+        std::vector<std::pair<size_t, std::string>> materialChanges; // (chunk 안의 삼각형 번호, 이름)
+        std::vector<std::string> materialLibs;
+
+        size_t positionOffset { 0 };
+        size_t texCoordOffset { 0 };
+        size_t normalOffset { 0 };
+        bool failed { false };
+    };
+
+    // 연속한 삼각형 범위를 같은 material로 묶은 것
+    struct TriangleRun {
+        size_t chunk;
+        size_t first;
+        size_t last;
+    };
+
+    const char* SkipSpaces(const char* p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\t'))
+            p++;
+        return p;
+    }
+
+    bool ParseFloat(const char*& p, const char* end, float& value) {
+        p = SkipSpaces(p, end);
+        if (p < end && *p == '+')
+            p++;
+        auto result = std::from_chars(p, end, value);
+        if (result.ec != std::errc())
+            return false;
+        p = result.ptr;
+        return true;
+    }
+
+    bool ParseInt(const char*& p, const char* end, int32_t& value) {
+        if (p < end && *p == '+')
+            p++;
+        auto result = std::from_chars(p, end, value);
+        if (result.ec != std::errc())
+            return false;
+        p = result.ptr;
+        return true;
+    }
+
+    bool IsKeyword(const char* p, const char* end, const char* keyword) {
+        size_t length = strlen(keyword);
+        if ((size_t)(end - p) < length || memcmp(p, keyword, length) != 0)
+            return false;
+        return p + length == end || p[length] == ' ' || p[length] == '\t';
+    }
+
+    std::string GetArgument(const char* p, const char* end) {
+        p = SkipSpaces(p, end);
+        while (end > p && (end[-1] == ' ' || end[-1] == '\t'))
+            end--;
+        return std::string(p, end);
+    }
+
+    // 1부터 시작하는 obj 번호를 Corner에 저장할 값으로 바꿈
+    int32_t ToLocalIndex(int32_t index, size_t localCount, uint8_t bit, uint8_t& relative) {
+        if (index > 0)
+            return index - 1;
+        relative |= bit;
+        return (int32_t)localCount + index;
+    }
+
+    bool ParseFace(const char* p, const char* end, Chunk& chunk) {
+        Corner corners[64];
+        int count = 0;
+        while (true) {
+            p = SkipSpaces(p, end);
+            if (p >= end)
+                break;
+            if (count == 64)
+                return false;
+
+            int32_t v = 0, vt = 0, vn = 0;
+            if (!ParseInt(p, end, v) || v == 0)
+                return false;
+            if (p < end && *p == '/') {
+                p++;
+                if (p < end && *p != '/' && !ParseInt(p, end, vt))
+                    return false;
+                if (p < end && *p == '/') {
+                    p++;
+                    if (!ParseInt(p, end, vn))
+                        return false;
+                }
+            }
+
+            auto& corner = corners[count++];
+            corner.v = ToLocalIndex(v, chunk.positions.size(), RELATIVE_V, corner.relative);
+            if (vt)
+                corner.vt = ToLocalIndex(vt, chunk.texCoords.size(), RELATIVE_VT, corner.relative);
+            if (vn)
+                corner.vn = ToLocalIndex(vn, chunk.normals.size(), RELATIVE_VN, corner.relative);
+        }
+
+        // 점, 선은 무시
+        for (int i = 2; i < count; i++) {
+            chunk.corners.push_back(corners[0]);
+            chunk.corners.push_back(corners[i - 1]);
+            chunk.corners.push_back(corners[i]);
+        }
+        return true;
+    }
+
+    // 여러 chunk가 함께 갱신하는 parse 진행 상태
+    struct ParseState {
+        ModelLoadProgress* progress { nullptr };
+        std::atomic<size_t> parsedBytes { 0 };
+        size_t totalBytes { 0 };
+    };
+
+    void ParseChunk(Chunk& chunk, ParseState& state) {
+        const char* p = chunk.begin;
+        const char* reported = p;
+        while (p < chunk.end && !chunk.failed) {
+            if (state.progress && (size_t)(p - reported) >= kProgressInterval) {
+                size_t parsed = state.parsedBytes += (size_t)(p - reported);
+                reported = p;
+                state.progress->progress = kParseProgress * parsed / state.totalBytes;
+                if (state.progress->canceled)
+                    return;
+            }
+
+            const char* lineEnd = (const char*)memchr(p, '\n', chunk.end - p);
+            if (!lineEnd)
+                lineEnd = chunk.end;
+            const char* next = lineEnd < chunk.end ? lineEnd + 1 : chunk.end;
+            if (lineEnd > p && lineEnd[-1] == '\r')
+                lineEnd--;
+
+            p = SkipSpaces(p, lineEnd);
+            if (p >= lineEnd || *p == '#') {
+                p = next;
+                continue;
+            }
+
+            if (IsKeyword(p, lineEnd, "v")) {
+                glm::vec3 position;
+                const char* q = p + 1;
+                chunk.failed = !ParseFloat(q, lineEnd, position.x) ||
+                    !ParseFloat(q, lineEnd, position.y) || !ParseFloat(q, lineEnd, position.z);
+                chunk.positions.push_back(position);
+            }
+            else if (IsKeyword(p, lineEnd, "vt")) {
+                glm::vec2 texCoord = glm::vec2(0.0f);
+                const char* q = p + 2;
+                chunk.failed = !ParseFloat(q, lineEnd, texCoord.x);
+                if (SkipSpaces(q, lineEnd) < lineEnd)
+                    chunk.failed |= !ParseFloat(q, lineEnd, texCoord.y);
+                chunk.texCoords.push_back(glm::vec2(texCoord.x, 1.0f - texCoord.y));
+            }
+            else if (IsKeyword(p, lineEnd, "vn")) {
+                glm::vec3 normal;
+                const char* q = p + 2;
+                chunk.failed = !ParseFloat(q, lineEnd, normal.x) ||
+                    !ParseFloat(q, lineEnd, normal.y) || !ParseFloat(q, lineEnd, normal.z);
+                chunk.normals.push_back(normal);
+            }
+            else if (IsKeyword(p, lineEnd, "f")) {
+                chunk.failed = !ParseFace(p + 1, lineEnd, chunk);
+            }
+            else if (IsKeyword(p, lineEnd, "usemtl")) {
+                chunk.materialChanges.push_back({ chunk.corners.size() / 3, GetArgument(p + 6, lineEnd) });
+            }
+            else if (IsKeyword(p, lineEnd, "mtllib")) {
+                chunk.materialLibs.push_back(GetArgument(p + 6, lineEnd));
+            }
+            // o, g, s 등 나머지는 무시
+
+            if (chunk.failed)
+                SPDLOG_ERROR("failed to parse obj line: {}", std::string(p, lineEnd));
+            p = next;
+        }
+    }
+
+    int32_t Resolve(int32_t index, size_t offset, bool relative) {
+        return relative ? (int32_t)((int64_t)offset + index) : index;
+    }
+
+    bool LoadMtl(const std::string& filename, std::vector<ModelData::MaterialData>& materials) {
+        std::ifstream file(filename);
+        if (!file.is_open()) {
+            SPDLOG_ERROR("failed to open mtl: {}", filename);
+            return false;
+        }
+
+        std::string line;
+        while (std::getline(file, line)) {
+            const char* p = line.data();
+            const char* end = p + line.size();
+            if (end > p && end[-1] == '\r')
+                end--;
+            p = SkipSpaces(p, end);
+
+            if (IsKeyword(p, end, "newmtl")) {
+                materials.push_back(ModelData::MaterialData());
+                materials.back().name = GetArgument(p + 6, end);
+            }
+            else if (materials.empty()) {
+                continue;
+            }
+            // 옵션(-bm 등)이 붙을 수 있으므로 마지막 단어를 경로로 사용
+            else if (IsKeyword(p, end, "map_Kd") || IsKeyword(p, end, "map_Ks")) {
+                auto argument = GetArgument(p + 6, end);
+                auto pos = argument.find_last_of(" \t");
+                auto path = pos == std::string::npos ? argument : argument.substr(pos + 1);
+                if (p[5] == 'd')
+                    materials.back().diffuseTexture = path;
+                else
+                    materials.back().specularTexture = path;
+            }
+        }
+        return true;
+    }
+
+    struct CornerHash {
+        size_t operator()(const Corner& corner) const {
+            size_t hash = (size_t)(uint32_t)corner.v * 73856093u;
+            hash ^= (size_t)(uint32_t)corner.vt * 19349663u;
+            hash ^= (size_t)(uint32_t)corner.vn * 83492791u;
+            return hash;
+        }
+    };
+
+    struct CornerEqual {
+        bool operator()(const Corner& a, const Corner& b) const {
+            return a.v == b.v && a.vt == b.vt && a.vn == b.vn;
+        }
+    };
+}
+
+bool LoadObj(const std::string& filename, ModelData& data, ThreadPool* pool,
+    ModelLoadProgress* progress) {
+    auto file = MappedFile::Open(filename);
+    if (!file)
+        return false;
+
+    auto ParallelFor = [pool](size_t count, const std::function<void(size_t)>& func) {
+        if (pool) {
+            pool->ParallelFor(count, func);
+            return;
+        }
+        for (size_t i = 0; i < count; i++)
+            func(i);
+    };
+
+    // 줄바꿈 위치에 맞춰 chunk 분할
+    const char* begin = (const char*)file->GetData();
+    const char* end = begin + file->GetSize();
+    size_t chunkCount = pool ? pool->GetThreadCount() + 1 : 1;
+    chunkCount = std::max<size_t>(1, std::min(chunkCount, file->GetSize() / kMinChunkSize));
+
+    std::vector<Chunk> chunks(chunkCount);
+    const char* p = begin;
+    for (size_t i = 0; i < chunkCount; i++) {
+        const char* chunkEnd = (i + 1 == chunkCount) ? end : begin + file->GetSize() * (i + 1) / chunkCount;
+        chunkEnd = std::max(chunkEnd, p);
+        const char* newline = (const char*)memchr(chunkEnd, '\n', end - chunkEnd);
+        chunkEnd = newline ? newline + 1 : end;
+        chunks[i].begin = p;
+        chunks[i].end = chunkEnd;
+        p = chunkEnd;
+    }
+
+    ParseState state;
+    state.progress = progress;
+    state.totalBytes = std::max<size_t>(1, file->GetSize());
+    ParallelFor(chunkCount, [&chunks, &state](size_t i) { ParseChunk(chunks[i], state); });
+    if (progress && progress->canceled)
+        return false;
+    for (auto& chunk : chunks) {
+        if (chunk.failed) {
+            SPDLOG_ERROR("failed to parse obj: {}", filename);
+            return false;
+        }
+    }
+
+    // chunk마다 v, vt, vn 시작 번호를 정하고 하나의 배열로 합침
+    size_t positionCount = 0, texCoordCount = 0, normalCount = 0;
+    for (auto& chunk : chunks) {
+        chunk.positionOffset = positionCount;
+        chunk.texCoordOffset = texCoordCount;
+        chunk.normalOffset = normalCount;
+        positionCount += chunk.positions.size();
+        texCoordCount += chunk.texCoords.size();
+        normalCount += chunk.normals.size();
+    }
+    if (positionCount > (size_t)INT32_MAX || texCoordCount > (size_t)INT32_MAX ||
+        normalCount > (size_t)INT32_MAX) {
+        SPDLOG_ERROR("too many vertices in obj: {}", filename);
+        return false;
+    }
+
+    std::vector<glm::vec3> positions(positionCount);
+    std::vector<glm::vec2> texCoords(texCoordCount);
+    std::vector<glm::vec3> normals(normalCount);
+    std::vector<char> indexValid(chunkCount, 1);
+    ParallelFor(chunkCount, [&](size_t i) {
+        auto& chunk = chunks[i];
+        std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.positionOffset);
+        std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), texCoords.begin() + chunk.texCoordOffset);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.normalOffset);
+        chunk.positions = std::vector<glm::vec3>();
+        chunk.texCoords = std::vector<glm::vec2>();
+        chunk.normals = std::vector<glm::vec3>();
+
+        for (auto& corner : chunk.corners) {
+            int32_t vt = Resolve(corner.vt, chunk.texCoordOffset, corner.relative & RELATIVE_VT);
+            int32_t vn = Resolve(corner.vn, chunk.normalOffset, corner.relative & RELATIVE_VN);
+            corner.v = Resolve(corner.v, chunk.positionOffset, corner.relative & RELATIVE_V);
+            // 상대 참조가 파일 앞을 넘어가면 없는 값(kMissing)과 구분되지 않으므로 여기서 걸러냄
+            if (corner.v < 0 || corner.v >= (int32_t)positionCount ||
+                vt >= (int32_t)texCoordCount || vn >= (int32_t)normalCount ||
+                ((corner.relative & RELATIVE_VT) && vt < 0) || ((corner.relative & RELATIVE_VN) && vn < 0))
+                indexValid[i] = 0;
+            corner.vt = vt;
+            corner.vn = vn;
+            corner.relative = 0;
+        }
+    });
+    if (std::find(indexValid.begin(), indexValid.end(), 0) != indexValid.end()) {
+        SPDLOG_ERROR("invalid face index in obj: {}", filename);
+        return false;
+    }
+
+    // material library
+    data = ModelData();
+    auto dirname = filename.substr(0, filename.find_last_of("/\\") + 1);
+    for (auto& chunk : chunks) {
+        for (auto& lib : chunk.materialLibs)
+            LoadMtl(dirname + lib, data.materials);
+    }
+    std::unordered_map<std::string, int> materialIndices;
+    for (size_t i = 0; i < data.materials.size(); i++)
+        materialIndices.emplace(data.materials[i].name, (int)i);
+
+    // material이 바뀌는 위치로 삼각형을 나눠서 material별로 모음, mesh 순서는 처음 등장한 순서
+    std::vector<int> meshMaterials;
+    std::vector<std::vector<TriangleRun>> meshRuns;
+    int currentMaterial = -1;
+    auto AddRun = [&](size_t chunk, size_t first, size_t last) {
+        if (first >= last)
+            return;
+        auto it = std::find(meshMaterials.begin(), meshMaterials.end(), currentMaterial);
+        size_t mesh = it - meshMaterials.begin();
+        if (it == meshMaterials.end()) {
+            meshMaterials.push_back(currentMaterial);
+            meshRuns.push_back({});
+        }
+        meshRuns[mesh].push_back({ chunk, first, last });
+    };
+    for (size_t i = 0; i < chunkCount; i++) {
+        size_t first = 0;
+        for (auto& change : chunks[i].materialChanges) {
+            AddRun(i, first, change.first);
+            first = change.first;
+            auto it = materialIndices.find(change.second);
+            currentMaterial = it != materialIndices.end() ? it->second : -1;
+        }
+        AddRun(i, first, chunks[i].corners.size() / 3);
+    }
+
+    // mesh마다 동시에 vertex를 만듦, 법선이 없는 꼭짓점은 면 법선을 쓰고 공유하지 않음
+    data.meshes.resize(meshMaterials.size());
+    std::atomic<size_t> builtMeshes { 0 };
+    ParallelFor(data.meshes.size(), [&](size_t m) {
+        if (progress && progress->canceled)
+            return;
+        auto& mesh = data.meshes[m];
+        mesh.materialIndex = meshMaterials[m];
+
+        size_t triangleCount = 0;
+        for (auto& run : meshRuns[m])
+            triangleCount += run.last - run.first;
+        mesh.indices.reserve(triangleCount * 3);
+
+        std::unordered_map<Corner, uint32_t, CornerHash, CornerEqual> vertexIndices;
+        vertexIndices.reserve(triangleCount * 3 / 2);
+        for (auto& run : meshRuns[m]) {
+            const auto& corners = chunks[run.chunk].corners;
+            for (size_t t = run.first; t < run.last; t++) {
+                const Corner* triangle = &corners[t * 3];
+                glm::vec3 faceNormal = glm::vec3(0.0f);
+                if (triangle[0].vn < 0 || triangle[1].vn < 0 || triangle[2].vn < 0) {
+                    faceNormal = glm::cross(
+                        positions[triangle[1].v] - positions[triangle[0].v],
+                        positions[triangle[2].v] - positions[triangle[0].v]);
+                    float length = glm::length(faceNormal);
+                    faceNormal = length > 0.0f ? faceNormal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+                }
+
+                for (int k = 0; k < 3; k++) {
+                    const auto& corner = triangle[k];
+                    if (corner.vn >= 0) {
+                        auto result = vertexIndices.emplace(corner, (uint32_t)mesh.vertices.size());
+                        if (!result.second) {
+                            mesh.indices.push_back(result.first->second);
+                            continue;
+                        }
+                    }
+
+                    Vertex vertex;
+                    vertex.position = positions[corner.v];
+                    vertex.normal = corner.vn >= 0 ? normals[corner.vn] : faceNormal;
+                    vertex.texCoord = corner.vt >= 0 ? texCoords[corner.vt] : glm::vec2(0.0f);
+                    vertex.tangent = glm::vec3(0.0f);
+                    mesh.indices.push_back((uint32_t)mesh.vertices.size());
+                    mesh.vertices.push_back(vertex);
+                }
+            }
+        }
+
+        if (progress) {
+            size_t built = ++builtMeshes;
+            progress->progress = kParseProgress + (1.0f - kParseProgress) * built / data.meshes.size();
+        }
+    });
+
+    return !(progress && progress->canceled);
+}
\ No newline at end of file
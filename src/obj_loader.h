@@ -0,0 +1,45 @@
+#ifndef __OBJ_LOADER_H__
+#define __OBJ_LOADER_H__
+
+#include "common.h"
+#include "mesh.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <vector>
+
+// GL 객체를 만들기 전의 CPU 쪽 모델 데이터
+struct ModelData {
+    struct MeshData {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        int materialIndex { -1 };
+        AABB bounds; // tangent와 함께 Model에서 계산
+    };
+    // texture 경로는 모델 파일이 있는 폴더 기준 상대 경로
+    struct MaterialData {
+        std::string name;
+        std::string diffuseTexture;
+        std::string specularTexture;
+    };
+
+    std::vector<MeshData> meshes;
+    std::vector<MaterialData> materials;
+};
+
+// 다른 thread에서 진행률을 읽고 취소를 요청할 수 있도록 loader에 넘기는 상태
+struct ModelLoadProgress {
+    std::atomic<float> progress { 0.0f }; // 0 ~ 1
+    std::atomic<bool> canceled { false };
+};
+
+/*
+assimp를 거치지 않는 Wavefront OBJ / MTL reader
+파일을 map한 뒤 줄 단위로 나눈 chunk를 pool에서 동시에 parse (pool이 없으면 현재 thread에서 처리)
+polygon은 fan으로 삼각형화, usemtl마다 material별 mesh로 묶고 같은 v/vt/vn 조합은 vertex 하나로 합침
+texture 좌표는 aiProcess_FlipUVs와 같게 v를 뒤집어서 저장
+*/
+// progress가 있으면 parse 중에 진행률을 갱신하고 취소되면 false
+bool LoadObj(const std::string& filename, ModelData& data, ThreadPool* pool = nullptr,
+    ModelLoadProgress* progress = nullptr);
+
+#endif // __OBJ_LOADER_H__
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "obj_writer.h"
+#include <charconv>
+
+ObjWriter::ObjWriter(std::ostream& out, size_t bufferSize) : m_out(&out) {
+    m_buffer.resize(std::max(bufferSize, kMaxLineLength));
+    m_good = m_out->good();
+}
+
+ObjWriter::ObjWriter() {
+    m_buffer.resize(kMaxLineLength * 64);
+}
+
+ObjWriter::~ObjWriter() {
+    Flush();
+}
+
+// 메모리 writer는 내용을 버림
+bool ObjWriter::Flush() {
+    if (m_out && m_good && m_size > 0) {
+        m_out->write(m_buffer.data(), m_size);
+        m_good = m_out->good();
+    }
+    m_size = 0;
+    return m_good;
+}
+
+void ObjWriter::Write(std::string_view text) {
+    if (m_size + text.size() > m_buffer.size()) {
+        if (!m_out) {
+            m_buffer.resize(std::max(m_buffer.size() * 2, m_size + text.size()));
+        }
+        else {
+            Flush();
+            // 버퍼보다 긴 문자열은 그대로 내보냄
+            if (text.size() > m_buffer.size()) {
+                if (m_good) {
+                    m_out->write(text.data(), text.size());
+                    m_good = m_out->good();
+                }
+                return;
+            }
+        }
+    }
+    memcpy(m_buffer.data() + m_size, text.data(), text.size());
+    m_size += text.size();
+}
+
+void ObjWriter::WriteChunks(ThreadPool* pool, size_t itemCount, size_t itemsPerChunk,
+    const ChunkFormatter& format) {
+    itemsPerChunk = std::max<size_t>(1, itemsPerChunk);
+    size_t chunkCount = (itemCount + itemsPerChunk - 1) / itemsPerChunk;
+    if (!pool || chunkCount <= 1) {
+        if (itemCount > 0)
+            format(*this, 0, itemCount);
+        return;
+    }
+
+    size_t waveSize = std::min(chunkCount, (pool->GetThreadCount() + 1) * 2);
+    while (m_chunkWriters.size() < waveSize)
+        m_chunkWriters.push_back(std::unique_ptr<ObjWriter>(new ObjWriter()));
+
+    for (size_t waveStart = 0; waveStart < chunkCount && m_good; waveStart += waveSize) {
+        size_t count = std::min(waveSize, chunkCount - waveStart);
+        pool->ParallelFor(count, [&](size_t i) {
+            auto& writer = *m_chunkWriters[i];
+            writer.m_size = 0;
+            size_t first = (waveStart + i) * itemsPerChunk;
+            format(writer, first, std::min(first + itemsPerChunk, itemCount));
+        });
+        for (size_t i = 0; i < count; i++) {
+            auto& writer = *m_chunkWriters[i];
+            Write(std::string_view(writer.m_buffer.data(), writer.m_size));
+            writer.m_size = 0;
+        }
+    }
+}
+
+char* ObjWriter::Append(char* p, float value) {
+    // 기존 std::ofstream 출력과 같은 %g, precision 6
+    return std::to_chars(p, p + kMaxLineLength / 4, value, std::chars_format::general, 6).ptr;
+}
+
+char* ObjWriter::Append(char* p, uint64_t value) {
+    return std::to_chars(p, p + kMaxLineLength / 4, value).ptr;
+}
+
+void ObjWriter::WritePosition(const glm::vec3& position) {
+    char* begin = Reserve();
+    char* p = begin;
+    *p++ = 'v';
+    *p++ = ' ';
+    p = Append(p, position.x);
+    *p++ = ' ';
+    p = Append(p, position.y);
+    *p++ = ' ';
+    p = Append(p, position.z);
+    *p++ = '\n';
+    m_size += p - begin;
+}
+
+void ObjWriter::WriteTexCoord(const glm::vec2& texCoord) {
+    char* begin = Reserve();
+    char* p = begin;
+    *p++ = 'v';
+    *p++ = 't';
+    *p++ = ' ';
+    p = Append(p, texCoord.x);
+    *p++ = ' ';
+    p = Append(p, texCoord.y);
+    *p++ = '\n';
+    m_size += p - begin;
+}
+
+void ObjWriter::WriteNormal(const glm::vec3& normal) {
+    char* begin = Reserve();
+    char* p = begin;
+    *p++ = 'v';
+    *p++ = 'n';
+    *p++ = ' ';
+    p = Append(p, normal.x);
+    *p++ = ' ';
+    p = Append(p, normal.y);
+    *p++ = ' ';
+    p = Append(p, normal.z);
+    *p++ = '\n';
+    m_size += p - begin;
+}
+
+void ObjWriter::WriteFace(uint64_t a, uint64_t b, uint64_t c) {
+    char* begin = Reserve();
+    char* p = begin;
+    *p++ = 'f';
+    for (uint64_t index : { a, b, c }) {
+        *p++ = ' ';
+        char* number = p;
+        p = Append(p, index);
+        size_t length = p - number;
+        *p++ = '/';
+        memcpy(p, number, length);
+        p += length;
+        *p++ = '/';
+        memcpy(p, number, length);
+        p += length;
+    }
+    *p++ = '\n';
+    m_size += p - begin;
+}
+
+void ObjWriter::WriteFace(const FaceVertex& a, const FaceVertex& b, const FaceVertex& c) {
+    char* begin = Reserve();
+    char* p = begin;
+    *p++ = 'f';
+    for (const FaceVertex* vertex : { &a, &b, &c }) {
+        *p++ = ' ';
+        p = Append(p, vertex->position);
+        *p++ = '/';
+        p = Append(p, vertex->texCoord);
+        *p++ = '/';
+        p = Append(p, vertex->normal);
+    }
+    *p++ = '\n';
+    m_size += p - begin;
+}
\ No newline at end of file
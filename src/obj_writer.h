@@ -0,0 +1,76 @@
+#ifndef __OBJ_WRITER_H__
+#define __OBJ_WRITER_H__
+
+#include "common.h"
+#include "thread_pool.h"
+#include <functional>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+/*
+Wavefront OBJ 한 줄씩을 std::to_chars로 재사용하는 버퍼에 직접 쓰고, 버퍼가 차면 한 번에 out으로 보냄
+숫자는 iostream 기본값과 같은 형식 (%g, 유효숫자 6자리)이라 기존 출력과 내용이 같음
+소멸 시 남은 버퍼를 flush
+*/
+class ObjWriter {
+public:
+    // format(writer, first, last): [first, last) 범위의 항목을 writer에 씀
+    using ChunkFormatter = std::function<void(ObjWriter& writer, size_t first, size_t last)>;
+
+    explicit ObjWriter(std::ostream& out, size_t bufferSize = 1 << 20);
+    // 출력 대상 없이 메모리 버퍼에만 쓰는 writer (버퍼가 계속 늘어남)
+    ObjWriter();
+    ~ObjWriter();
+
+    void Write(std::string_view text);
+    void WritePosition(const glm::vec3& position);  // v x y z
+    void WriteTexCoord(const glm::vec2& texCoord);  // vt u v
+    void WriteNormal(const glm::vec3& normal);      // vn x y z
+    // 면의 한 꼭짓점이 가리키는 v, vt, vn 번호
+    struct FaceVertex {
+        uint64_t position;
+        uint64_t texCoord;
+        uint64_t normal;
+    };
+
+    // f a/a/a b/b/b c/c/c, 번호는 1부터 시작
+    void WriteFace(uint64_t a, uint64_t b, uint64_t c);
+    // f v/vt/vn v/vt/vn v/vt/vn
+    void WriteFace(const FaceVertex& a, const FaceVertex& b, const FaceVertex& c);
+
+    /*
+    itemCount개의 항목을 itemsPerChunk개씩 나눠 pool에서 동시에 format하고 chunk 순서대로 씀
+    한 번에 (thread 수 * 2)개 chunk씩 처리하므로 메모리는 그만큼만 사용, 결과는 순서대로 쓴 것과 같음
+    pool이 없거나 chunk가 하나뿐이면 이 writer에 바로 씀
+    */
+    void WriteChunks(ThreadPool* pool, size_t itemCount, size_t itemsPerChunk, const ChunkFormatter& format);
+
+    // 실패하면 false, 이후 쓰기는 무시됨
+    bool Flush();
+    bool IsGood() const { return m_good; }
+
+private:
+    // 한 줄의 최대 길이, 버퍼에 이만큼 남아있지 않으면 먼저 flush
+    static constexpr size_t kMaxLineLength = 256;
+
+    char* Reserve() {
+        if (m_size + kMaxLineLength > m_buffer.size()) {
+            if (m_out)
+                Flush();
+            else
+                m_buffer.resize(m_buffer.size() * 2);
+        }
+        return m_buffer.data() + m_size;
+    }
+    char* Append(char* p, float value);
+    char* Append(char* p, uint64_t value);
+
+    std::ostream* m_out { nullptr };
+    std::vector<char> m_buffer;
+    size_t m_size { 0 };
+    bool m_good { true };
+    std::vector<std::unique_ptr<ObjWriter>> m_chunkWriters; // WriteChunks에서 재사용
+};
+
+#endif // __OBJ_WRITER_H__
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include "pixel_uploader.h"
+#include <cstring>
+
+namespace {
+    // 한 프레임에 GL로 넘기는 양, 적어도 한 작업은 처리함
+    const size_t kMaxUploadBytesPerFrame = 16 * 1024 * 1024;
+    const size_t kSlotGranularity = 1024 * 1024;
+}
+
+PixelUploaderUPtr PixelUploader::Create(ThreadPool* threadPool, int slotCount) {
+    auto uploader = PixelUploaderUPtr(new PixelUploader());
+    if (!uploader->Init(threadPool, slotCount))
+        return nullptr;
+    return std::move(uploader);
+}
+
+bool PixelUploader::Init(ThreadPool* threadPool, int slotCount) {
+    if (!threadPool || slotCount <= 0)
+        return false;
+    m_threadPool = threadPool;
+    m_slots.resize(slotCount);
+    for (auto& slot : m_slots)
+        glGenBuffers(1, &slot.buffer);
+    return true;
+}
+
+PixelUploader::~PixelUploader() {
+    for (auto& slot : m_slots) {
+        if (slot.fence)
+            glDeleteSync(slot.fence);
+        if (slot.buffer)
+            glDeleteBuffers(1, &slot.buffer);
+    }
+}
+
+void PixelUploader::Upload(std::vector<ImagePtr> images, UploadCallback callback) {
+    auto job = std::make_shared<Job>();
+    for (auto& image : images) {
+        job->offsets.push_back(job->size);
+        size_t bytes = (size_t)image->GetWidth() * image->GetHeight() * image->GetChannelCount();
+        job->size += (bytes + 3) & ~(size_t)3;
+    }
+    if (job->size == 0)
+        return;
+    job->images = std::move(images);
+    job->callback = std::move(callback);
+    m_waiting.push_back(job);
+}
+
+int PixelUploader::AcquireSlot(size_t size) {
+    for (int i = 0; i < (int)m_slots.size(); i++) {
+        auto& slot = m_slots[i];
+        if (slot.busy)
+            continue;
+
+        // 버퍼가 작으면 필요한 크기로 다시 할당
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+        if (slot.capacity < size) {
+            slot.capacity = (size + kSlotGranularity - 1) / kSlotGranularity * kSlotGranularity;
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, slot.capacity, nullptr, GL_STREAM_DRAW);
+        }
+        slot.busy = true;
+        return i;
+    }
+    return -1;
+}
+
+void PixelUploader::StartCopy(const std::shared_ptr<Job>& job) {
+    auto& slot = m_slots[job->slot];
+    // fence가 풀린 slot만 map하므로 GPU가 아직 읽는 중인 메모리와 겹치지 않음
+    auto mapped = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, job->size,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (!mapped) {
+        SPDLOG_ERROR("failed to map pixel unpack buffer");
+        slot.busy = false;
+        return;
+    }
+
+    m_copying.push_back(job);
+    m_threadPool->Enqueue([job, mapped]() {
+        for (size_t i = 0; i < job->images.size(); i++) {
+            const auto& image = job->images[i];
+            size_t bytes = (size_t)image->GetWidth() * image->GetHeight() * image->GetChannelCount();
+            memcpy(mapped + job->offsets[i], image->GetData(), bytes);
+            // PBO로 옮겼으므로 CPU 쪽 픽셀은 바로 해제
+            image->Release();
+        }
+        job->copied = true;
+    });
+}
+
+void PixelUploader::FinishCopy(const std::shared_ptr<Job>& job) {
+    auto& slot = m_slots[job->slot];
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+    if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE) {
+        // 3채널 이미지의 행이 4byte 단위가 아닐 수 있음
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        job->callback(job->offsets);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    else {
+        SPDLOG_ERROR("pixel unpack buffer was corrupted during upload");
+    }
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void PixelUploader::Update() {
+    // GPU가 다 읽은 slot 반환
+    for (auto& slot : m_slots) {
+        if (!slot.fence)
+            continue;
+        GLenum result = glClientWaitSync(slot.fence, 0, 0);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+            slot.busy = false;
+        }
+    }
+
+    // 복사가 끝난 작업을 순서대로 GL에 넘김
+    size_t uploadedBytes = 0;
+    while (!m_copying.empty() && m_copying.front()->copied) {
+        if (uploadedBytes > 0 && uploadedBytes + m_copying.front()->size > kMaxUploadBytesPerFrame)
+            break;
+        uploadedBytes += m_copying.front()->size;
+        FinishCopy(m_copying.front());
+        m_copying.pop_front();
+    }
+
+    // 빈 slot이 있으면 다음 작업의 복사 시작
+    while (!m_waiting.empty()) {
+        auto job = m_waiting.front();
+        job->slot = AcquireSlot(job->size);
+        if (job->slot < 0)
+            break;
+        m_waiting.pop_front();
+        StartCopy(job);
+    }
+}
\ No newline at end of file
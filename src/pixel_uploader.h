@@ -0,0 +1,64 @@
+#ifndef __PIXEL_UPLOADER_H__
+#define __PIXEL_UPLOADER_H__
+
+#include "common.h"
+#include "image.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <deque>
+#include <functional>
+
+/*
+GL_PIXEL_UNPACK_BUFFER ring을 이용한 texture upload
+1. main thread: 비어있는 slot을 map해서 포인터를 worker에 넘김
+2. worker: decode된 이미지를 map된 메모리로 복사
+3. main thread: unmap 후 PBO를 bind한 채로 callback 호출 (glTexSubImage2D의 data 자리에 offset 사용)
+   그 뒤 fence를 걸고, GPU가 다 읽었을 때 slot을 다시 사용
+render thread는 memcpy도, client memory에서의 동기 전송도 하지 않음
+*/
+CLASS_PTR(PixelUploader)
+class PixelUploader {
+public:
+    // offsets[i]는 images[i]가 PBO 안에서 시작하는 위치, (const void*)로 바꿔서 GL에 전달
+    using UploadCallback = std::function<void(const std::vector<size_t>& offsets)>;
+
+    static PixelUploaderUPtr Create(ThreadPool* threadPool, int slotCount = 4);
+    ~PixelUploader();
+
+    // images 전체가 한 slot에 연속으로 들어감
+    void Upload(std::vector<ImagePtr> images, UploadCallback callback);
+    // 매 프레임 main thread에서 호출
+    void Update();
+    size_t GetPendingCount() const { return m_waiting.size() + m_copying.size(); }
+
+private:
+    PixelUploader() {}
+    bool Init(ThreadPool* threadPool, int slotCount);
+
+    struct Job {
+        std::vector<ImagePtr> images;
+        std::vector<size_t> offsets;
+        size_t size { 0 };
+        UploadCallback callback;
+        int slot { -1 };
+        std::atomic<bool> copied { false };
+    };
+
+    struct Slot {
+        uint32_t buffer { 0 };
+        size_t capacity { 0 };
+        bool busy { false };
+        GLsync fence { nullptr };
+    };
+
+    int AcquireSlot(size_t size);
+    void StartCopy(const std::shared_ptr<Job>& job);
+    void FinishCopy(const std::shared_ptr<Job>& job);
+
+    ThreadPool* m_threadPool { nullptr };
+    std::vector<Slot> m_slots;
+    std::deque<std::shared_ptr<Job>> m_waiting;
+    std::deque<std::shared_ptr<Job>> m_copying;
+};
+
+#endif // __PIXEL_UPLOADER_H__
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "common.h"
 #include "program.h"
+#include <filesystem>
+#include <fstream>
 
 ProgramUPtr Program::Create(const std::vector<ShaderPtr>& shaders){
     auto program = ProgramUPtr(new Program());
@@ -9,19 +11,94 @@ ProgramUPtr Program::Create(const std::vector<ShaderPtr>& shaders){
     return std::move(program);
 }
 
+namespace {
+    bool s_binaryCacheEnabled = true;
+    Program::BinaryCacheStats s_binaryCacheStats;
+    const char* kBinaryCacheDir = "./cache";
+    const uint32_t kBinaryCacheMagic = 0x4e494250; // "PBIN"
+
+    // GL_ARB_get_program_binary (4.1 core)가 있고 지원하는 binary format이 하나라도 있어야 함
+    bool IsBinaryCacheAvailable() {
+        if (!s_binaryCacheEnabled)
+            return false;
+        if (!GLAD_GL_VERSION_4_1 && !GLAD_GL_ARB_get_program_binary)
+            return false;
+        int formatCount = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        return formatCount > 0;
+    }
+
+    // 64bit FNV-1a
+    uint64_t HashString(uint64_t hash, const std::string& text) {
+        for (unsigned char c : text) {
+            hash ^= c;
+            hash *= 0x100000001b3ull;
+        }
+        // 경계가 다른 두 문자열 조합이 같은 hash가 되지 않도록 구분자 추가
+        hash ^= 0xff;
+        hash *= 0x100000001b3ull;
+        return hash;
+    }
+
+    std::string GetGLString(GLenum name) {
+        auto value = glGetString(name);
+        return value ? std::string((const char*)value) : std::string();
+    }
+
+    // driver가 바뀌면 binary를 쓸 수 없으므로 GL 버전 / vendor / renderer도 key에 포함
+    std::string GetBinaryCachePath(const std::string& vertexCode, const std::string& fragmentCode) {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        hash = HashString(hash, vertexCode);
+        hash = HashString(hash, fragmentCode);
+        hash = HashString(hash, GetGLString(GL_VERSION));
+        hash = HashString(hash, GetGLString(GL_VENDOR));
+        hash = HashString(hash, GetGLString(GL_RENDERER));
+        return fmt::format("{}/{:016x}.bin", kBinaryCacheDir, hash);
+    }
+}
+
 ProgramUPtr Program::Create(const std::string& vertShaderFilename,
     const std::string& fragShaderFilename) {
+    std::string cachePath;
+    if (IsBinaryCacheAvailable()) {
+        auto vertexCode = LoadTextFile(vertShaderFilename);
+        auto fragmentCode = LoadTextFile(fragShaderFilename);
+        if (!vertexCode.has_value() || !fragmentCode.has_value())
+            return nullptr;
+
+        cachePath = GetBinaryCachePath(vertexCode.value(), fragmentCode.value());
+        auto program = ProgramUPtr(new Program());
+        if (program->LoadBinary(cachePath)) {
+            s_binaryCacheStats.hits++;
+            return std::move(program);
+        }
+        s_binaryCacheStats.misses++;
+    }
+
     ShaderPtr vs = Shader::CreateFromFile(vertShaderFilename, GL_VERTEX_SHADER);
     ShaderPtr fs = Shader::CreateFromFile(fragShaderFilename, GL_FRAGMENT_SHADER);
     if (!vs || !fs)
         return nullptr;
-    return std::move(Create({vs, fs}));
+    auto program = Create({vs, fs});
+    if (program && !cachePath.empty())
+        program->SaveBinary(cachePath);
+    return std::move(program);
+}
+
+void Program::SetBinaryCacheEnabled(bool enabled) {
+    s_binaryCacheEnabled = enabled;
+}
+
+const Program::BinaryCacheStats& Program::GetBinaryCacheStats() {
+    return s_binaryCacheStats;
 }
 
 bool Program::Link(const std::vector<ShaderPtr>& shaders){
     m_program = glCreateProgram();
     for(auto& shader: shaders)
         glAttachShader(m_program, shader->Get());
+    if (IsBinaryCacheAvailable())
+        glProgramParameteri(m_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(m_program);
 
     int success = 0;
@@ -35,6 +112,67 @@ bool Program::Link(const std::vector<ShaderPtr>& shaders){
     return true;
 }
 
+// cache 파일: magic, binary format, binary 길이, binary
+// 파일이 없거나 driver가 binary를 거부하면 false를 돌려주고 호출한 쪽에서 compile
+bool Program::LoadBinary(const std::string& cachePath) {
+    std::ifstream fin(cachePath, std::ios::binary);
+    if (!fin.is_open())
+        return false;
+
+    uint32_t magic = 0;
+    uint32_t format = 0;
+    uint32_t length = 0;
+    fin.read((char*)&magic, sizeof(magic));
+    fin.read((char*)&format, sizeof(format));
+    fin.read((char*)&length, sizeof(length));
+    if (!fin || magic != kBinaryCacheMagic || length == 0)
+        return false;
+
+    std::vector<char> binary(length);
+    fin.read(binary.data(), length);
+    if (!fin)
+        return false;
+
+    m_program = glCreateProgram();
+    glProgramBinary(m_program, format, binary.data(), (GLsizei)length);
+
+    int success = 0;
+    glGetProgramiv(m_program, GL_LINK_STATUS, &success);
+    if (!success) {
+        SPDLOG_INFO("program binary rejected, recompiling: {}", cachePath);
+        glDeleteProgram(m_program);
+        m_program = 0;
+        return false;
+    }
+    return true;
+}
+
+void Program::SaveBinary(const std::string& cachePath) const {
+    int length = 0;
+    glGetProgramiv(m_program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(m_program, length, &length, &format, binary.data());
+
+    std::error_code error;
+    std::filesystem::create_directories(kBinaryCacheDir, error);
+    std::ofstream fout(cachePath, std::ios::binary);
+    if (!fout.is_open()) {
+        SPDLOG_ERROR("failed to write program binary: {}", cachePath);
+        return;
+    }
+    uint32_t magic = kBinaryCacheMagic;
+    uint32_t binaryFormat = format;
+    uint32_t binaryLength = (uint32_t)length;
+    fout.write((const char*)&magic, sizeof(magic));
+    fout.write((const char*)&binaryFormat, sizeof(binaryFormat));
+    fout.write((const char*)&binaryLength, sizeof(binaryLength));
+    fout.write(binary.data(), length);
+}
+
 Program::~Program(){
     if(m_program){
         glDeleteProgram(m_program);
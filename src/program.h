@@ -10,9 +10,17 @@ public:
     // shader의 메모리 주소만 전달받도록
     // shared pointer의 형태로 전달받음
     static ProgramUPtr Create(const std::vector<ShaderPtr>& shaders);
+    // 파일로부터 만드는 program은 ./cache의 program binary를 먼저 찾아보고 없으면 compile 후 저장
     static ProgramUPtr Create(const std::string& vertShaderFilename,
         const std::string& fragShaderFilename);
 
+    struct BinaryCacheStats {
+        uint32_t hits { 0 };
+        uint32_t misses { 0 };
+    };
+    static void SetBinaryCacheEnabled(bool enabled);
+    static const BinaryCacheStats& GetBinaryCacheStats();
+
     ~Program();
     uint32_t Get() const {return m_program;}
     void Use() const;
@@ -28,6 +36,8 @@ public:
 private:
     Program() {}
     bool Link(const std::vector<ShaderPtr>& shaders);
+    bool LoadBinary(const std::string& cachePath);
+    void SaveBinary(const std::string& cachePath) const;
     uint32_t m_program{0};
 };
 
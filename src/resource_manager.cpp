@@ -0,0 +1,90 @@
+#include "resource_manager.h"
+#include "image.h"
+#include <filesystem>
+
+ResourceManagerUPtr ResourceManager::Create() {
+    auto resources = ResourceManagerUPtr(new ResourceManager());
+    if (!resources->Init())
+        return nullptr;
+    return std::move(resources);
+}
+
+bool ResourceManager::Init() {
+    m_loader = AssetLoader::Create();
+    return m_loader ? true : false;
+}
+
+TexturePtr ResourceManager::GetTexture(const std::string& filepath, bool flipVertical) {
+    auto key = fmt::format("{}:{}", filepath, flipVertical);
+    return Find(m_textures, key, [&]() -> TexturePtr {
+        // TextureBaker로 미리 압축해둔 파일이 원본보다 새것이면 그걸 사용
+        auto bakedPath = filepath + ".tex";
+        std::error_code error;
+        auto bakedTime = std::filesystem::last_write_time(bakedPath, error);
+        if (!error) {
+            auto sourceTime = std::filesystem::last_write_time(filepath, error);
+            if (error || bakedTime >= sourceTime) {
+                auto texture = Texture::CreateFromContainer(bakedPath, flipVertical);
+                if (texture)
+                    return texture;
+            }
+        }
+        return m_loader->LoadTexture(filepath, flipVertical);
+    });
+}
+
+TexturePtr ResourceManager::GetSingleColorTexture(const glm::vec4& color) {
+    auto key = fmt::format("color:{},{},{},{}", color.r, color.g, color.b, color.a);
+    return Find(m_textures, key, [&]() -> TexturePtr {
+        return Texture::CreateFromImage(Image::CreateSingleColorImage(4, 4, color).get());
+    });
+}
+
+ProgramPtr ResourceManager::GetProgram(const std::string& vertShaderFilename,
+    const std::string& fragShaderFilename) {
+    auto key = fmt::format("{}|{}", vertShaderFilename, fragShaderFilename);
+    return Find(m_programs, key, [&]() -> ProgramPtr {
+        return Program::Create(vertShaderFilename, fragShaderFilename);
+    });
+}
+
+MeshPtr ResourceManager::GetBox() {
+    return Find(m_meshes, "box", []() -> MeshPtr {
+        return Mesh::CreateBox();
+    });
+}
+
+MeshPtr ResourceManager::GetCylinder(float radius, float height, float rate) {
+    auto key = fmt::format("cylinder:{},{},{}", radius, height, rate);
+    return Find(m_meshes, key, [&]() -> MeshPtr {
+        return Mesh::CreateCylinder(radius, height, rate);
+    });
+}
+
+MeshPtr ResourceManager::GetLeaf(float width, float height) {
+    auto key = fmt::format("leaf:{},{}", width, height);
+    return Find(m_meshes, key, [&]() -> MeshPtr {
+        return Mesh::CreateLeaf(width, height);
+    });
+}
+
+MeshPtr ResourceManager::GetSphere(float radius) {
+    auto key = fmt::format("sphere:{}", radius);
+    return Find(m_meshes, key, [&]() -> MeshPtr {
+        return Mesh::CreateSphere(radius);
+    });
+}
+
+void ResourceManager::Collect() {
+    auto collect = [](auto& cache) {
+        for (auto it = cache.begin(); it != cache.end();) {
+            if (it->second.expired())
+                it = cache.erase(it);
+            else
+                ++it;
+        }
+    };
+    collect(m_textures);
+    collect(m_programs);
+    collect(m_meshes);
+}
\ No newline at end of file
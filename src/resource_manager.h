@@ -0,0 +1,64 @@
+#ifndef __RESOURCE_MANAGER_H__
+#define __RESOURCE_MANAGER_H__
+
+#include "common.h"
+#include "texture.h"
+#include "program.h"
+#include "mesh.h"
+#include "asset_loader.h"
+#include <unordered_map>
+
+/*
+경로 / 생성 인자를 key로 GPU 리소스를 공유
+cache는 weak_ptr만 들고 있으므로 사용하는 쪽이 모두 놓으면 리소스도 해제됨
+같은 key로 다시 요청하면 살아있는 리소스를 그대로 돌려줌
+파일 texture는 AssetLoader로 비동기 decode하고 그동안은 placeholder를 보여줌
+*/
+CLASS_PTR(ResourceManager)
+class ResourceManager {
+public:
+    static ResourceManagerUPtr Create();
+
+    // 매 프레임 main thread에서 호출, decode가 끝난 texture를 upload
+    void Update() { m_loader->Update(); }
+    AssetLoader* GetLoader() const { return m_loader.get(); }
+
+    TexturePtr GetTexture(const std::string& filepath, bool flipVertical = true);
+    // 4x4 단색 texture
+    TexturePtr GetSingleColorTexture(const glm::vec4& color);
+    ProgramPtr GetProgram(const std::string& vertShaderFilename, const std::string& fragShaderFilename);
+
+    MeshPtr GetBox();
+    MeshPtr GetCylinder(float radius, float height, float rate);
+    MeshPtr GetLeaf(float width, float height);
+    MeshPtr GetSphere(float radius);
+
+    // 만료된 cache 항목 정리
+    void Collect();
+
+private:
+    ResourceManager() {}
+    bool Init();
+
+    template <typename T, typename Factory>
+    static std::shared_ptr<T> Find(std::unordered_map<std::string, std::weak_ptr<T>>& cache,
+        const std::string& key, Factory&& factory) {
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            if (auto resource = it->second.lock())
+                return resource;
+        }
+        std::shared_ptr<T> resource = factory();
+        if (resource)
+            cache[key] = resource;
+        return resource;
+    }
+
+    std::unordered_map<std::string, TextureWPtr> m_textures;
+    std::unordered_map<std::string, ProgramWPtr> m_programs;
+    std::unordered_map<std::string, MeshWPtr> m_meshes;
+
+    AssetLoaderUPtr m_loader;
+};
+
+#endif // __RESOURCE_MANAGER_H__
\ No newline at end of file
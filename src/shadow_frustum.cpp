@@ -0,0 +1,109 @@
+#include "shadow_frustum.h"
+
+namespace {
+    // log 분할과 uniform 분할의 비율 (1이면 log 분할만 사용)
+    const float kSplitLambda = 0.75f;
+    // 가장자리 texel이 잘리지 않도록 bounds를 조금 넓힘
+    const float kMargin = 0.1f;
+    const float kMinNear = 0.05f;
+}
+
+glm::mat4 ComputeLightView(const glm::vec3& position, const glm::vec3& direction) {
+    glm::vec3 dir = glm::normalize(direction);
+    glm::vec3 up = glm::abs(dir.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    return glm::lookAt(position, position + dir, up);
+}
+
+glm::mat4 FitDirectionalProjection(const glm::mat4& lightView, const AABB& sceneBounds) {
+    if (!sceneBounds.IsValid())
+        return glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, 1.0f, 100.0f);
+
+    // view space는 -z 방향을 바라보므로 near / far는 z의 부호를 뒤집은 값
+    AABB lightBounds = sceneBounds.Transform(lightView);
+    return glm::ortho(
+        lightBounds.min.x - kMargin, lightBounds.max.x + kMargin,
+        lightBounds.min.y - kMargin, lightBounds.max.y + kMargin,
+        -lightBounds.max.z - kMargin, -lightBounds.min.z + kMargin);
+}
+
+glm::mat4 FitSpotProjection(const glm::mat4& lightView, float fovy, const AABB& sceneBounds) {
+    if (!sceneBounds.IsValid())
+        return glm::perspective(fovy, 1.0f, 1.0f, 20.0f);
+
+    AABB lightBounds = sceneBounds.Transform(lightView);
+    float zNear = glm::max(kMinNear, -lightBounds.max.z - kMargin);
+    float zFar = glm::max(zNear + 1.0f, -lightBounds.min.z + kMargin);
+    return glm::perspective(fovy, 1.0f, zNear, zFar);
+}
+
+std::vector<ShadowCascade> ComputeCascades(const glm::mat4& lightView, const CameraFrustum& camera,
+    const AABB& sceneBounds, int cascadeCount, int resolution) {
+    cascadeCount = glm::max(cascadeCount, 1);
+    std::vector<ShadowCascade> cascades(cascadeCount);
+
+    // scene보다 먼 곳까지 나눠봐야 texel만 낭비되므로 far를 scene 끝까지로 줄임
+    float zNear = camera.zNear;
+    float zFar = camera.zFar;
+    AABB lightBounds;
+    if (sceneBounds.IsValid()) {
+        AABB viewBounds = sceneBounds.Transform(camera.view);
+        zFar = glm::clamp(-viewBounds.min.z, zNear + 1.0f, camera.zFar);
+        lightBounds = sceneBounds.Transform(lightView);
+    }
+
+    glm::mat4 invView = glm::inverse(camera.view);
+    float tanY = glm::tan(camera.fovy * 0.5f);
+    float tanX = tanY * camera.aspect;
+
+    float splitNear = zNear;
+    for (int i = 0; i < cascadeCount; i++) {
+        float t = (float)(i + 1) / (float)cascadeCount;
+        float logSplit = zNear * glm::pow(zFar / zNear, t);
+        float uniformSplit = zNear + (zFar - zNear) * t;
+        float splitFar = kSplitLambda * logSplit + (1.0f - kSplitLambda) * uniformSplit;
+
+        // 조각의 꼭짓점 8개를 world space로
+        glm::vec3 corners[8];
+        int index = 0;
+        for (float depth : { splitNear, splitFar }) {
+            for (float x : { -1.0f, 1.0f }) {
+                for (float y : { -1.0f, 1.0f }) {
+                    corners[index++] = glm::vec3(invView *
+                        glm::vec4(x * tanX * depth, y * tanY * depth, -depth, 1.0f));
+                }
+            }
+        }
+
+        // 구의 반지름은 카메라 회전과 무관하므로 회전해도 projection 크기가 변하지 않음
+        glm::vec3 center = glm::vec3(0.0f);
+        for (const auto& corner : corners)
+            center += corner;
+        center /= 8.0f;
+        float radius = 0.0f;
+        for (const auto& corner : corners)
+            radius = glm::max(radius, glm::length(corner - center));
+        radius = glm::ceil(radius * 16.0f) / 16.0f;
+
+        // 중심을 texel 크기 단위로 맞춰서 카메라 이동 시 그림자 가장자리가 떨리지 않게 함
+        glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+        float texelSize = 2.0f * radius / (float)glm::max(resolution, 1);
+        lightCenter.x = glm::floor(lightCenter.x / texelSize) * texelSize;
+        lightCenter.y = glm::floor(lightCenter.y / texelSize) * texelSize;
+
+        float depthNear = -lightCenter.z - radius;
+        float depthFar = -lightCenter.z + radius;
+        if (lightBounds.IsValid()) {
+            depthNear = -lightBounds.max.z - kMargin;
+            depthFar = -lightBounds.min.z + kMargin;
+        }
+
+        auto projection = glm::ortho(
+            lightCenter.x - radius, lightCenter.x + radius,
+            lightCenter.y - radius, lightCenter.y + radius,
+            depthNear, depthFar);
+        cascades[i].transform = projection * lightView;
+        cascades[i].splitDistance = splitFar;
+        splitNear = splitFar;
+    }
+    return cascades;
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef __SHADOW_FRUSTUM_H__
+#define __SHADOW_FRUSTUM_H__
+
+#include "common.h"
+#include "bounds.h"
+#include <vector>
+
+// cascade 하나: 카메라 기준 splitDistance까지를 덮는 빛의 view projection
+struct ShadowCascade {
+    glm::mat4 transform { glm::mat4(1.0f) };
+    float splitDistance { 0.0f };
+};
+
+// 카메라 frustum 정보 (cascade 분할용)
+struct CameraFrustum {
+    glm::mat4 view { glm::mat4(1.0f) };
+    float fovy { glm::radians(45.0f) };
+    float aspect { 1.0f };
+    float zNear { 0.1f };
+    float zFar { 100.0f };
+};
+
+// 빛의 방향이 수직에 가까우면 up 벡터를 바꿔서 lookAt이 망가지지 않게 함
+glm::mat4 ComputeLightView(const glm::vec3& position, const glm::vec3& direction);
+
+// 빛의 공간으로 옮긴 scene bounds에 딱 맞는 orthographic projection
+glm::mat4 FitDirectionalProjection(const glm::mat4& lightView, const AABB& sceneBounds);
+
+// spot light: 화각은 그대로 두고 near / far만 scene bounds에 맞춤
+glm::mat4 FitSpotProjection(const glm::mat4& lightView, float fovy, const AABB& sceneBounds);
+
+/*
+카메라 frustum을 cascadeCount개로 나누고 조각마다 빛의 ortho projection을 만듦
+- 분할: log / uniform 분할을 섞은 practical split
+- 조각을 감싸는 구로 맞추고 texel 단위로 이동시켜 카메라가 움직여도 그림자가 떨리지 않음
+- depth 범위는 scene bounds 전체를 덮어서 조각 밖의 그림자 caster도 포함
+*/
+std::vector<ShadowCascade> ComputeCascades(const glm::mat4& lightView, const CameraFrustum& camera,
+    const AABB& sceneBounds, int cascadeCount, int resolution);
+
+#endif // __SHADOW_FRUSTUM_H__
\ No newline at end of file
@@ -1,8 +1,8 @@
 #include "shadow_map.h"
 
-ShadowMapUPtr ShadowMap::Create(int width, int height) {
+ShadowMapUPtr ShadowMap::Create(int width, int height, int layers) {
     auto shadowMap = ShadowMapUPtr(new ShadowMap());
-    if (!shadowMap->Init(width, height))
+    if (!shadowMap->Init(width, height, layers))
         return nullptr;
     return std::move(shadowMap);
 }
@@ -17,19 +17,44 @@ void ShadowMap::Bind() const {
     glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
 }
 
-bool ShadowMap::Init(int width, int height) {
+void ShadowMap::BindLayer(int layer) const {
+    Bind();
+    if (m_shadowMapArray) {
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+            m_shadowMapArray->Get(), 0, layer);
+    }
+}
+
+bool ShadowMap::Init(int width, int height, int layers) {
+    m_width = width;
+    m_height = height;
+    m_layers = std::max(1, layers);
+
     glGenFramebuffers(1, &m_framebuffer);
     Bind();
 
-    m_shadowMap = Texture::Create(width, height, GL_DEPTH_COMPONENT, GL_FLOAT);
-    m_shadowMap->SetFilter(GL_NEAREST, GL_NEAREST);
-    m_shadowMap->SetWrap(GL_CLAMP_TO_BORDER, GL_CLAMP_TO_BORDER);
-    m_shadowMap->SetBorderColor(glm::vec4(1.0f));
-    
+    if (m_layers == 1) {
+        m_shadowMap = Texture::Create(width, height, GL_DEPTH_COMPONENT, GL_FLOAT);
+        // 비교 결과를 하드웨어가 주변 2x2 texel로 bilinear 보간 (PCF)
+        m_shadowMap->SetFilter(GL_LINEAR, GL_LINEAR);
+        m_shadowMap->SetCompareMode(true);
+        m_shadowMap->SetWrap(GL_CLAMP_TO_BORDER, GL_CLAMP_TO_BORDER);
+        m_shadowMap->SetBorderColor(glm::vec4(1.0f));
+
+        // Depth Attachment만
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+            GL_TEXTURE_2D, m_shadowMap->Get(), 0);
+    }
+    else {
+        m_shadowMapArray = Texture2DArray::Create(width, height, m_layers, GL_DEPTH_COMPONENT, GL_FLOAT);
+        m_shadowMapArray->SetFilter(GL_LINEAR, GL_LINEAR);
+        m_shadowMapArray->SetCompareMode(true);
+        m_shadowMapArray->SetWrap(GL_CLAMP_TO_BORDER, GL_CLAMP_TO_BORDER);
+        m_shadowMapArray->SetBorderColor(glm::vec4(1.0f));
 
-    // Depth Attachment만
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
-        GL_TEXTURE_2D, m_shadowMap->Get(), 0);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+            m_shadowMapArray->Get(), 0, 0);
+    }
     glDrawBuffer(GL_NONE);
     glReadBuffer(GL_NONE);
     auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
@@ -6,19 +6,30 @@
 CLASS_PTR(ShadowMap);
 class ShadowMap {
 public:
-    static ShadowMapUPtr Create(int width, int height);
+    // layers > 1 이면 cascade 용 texture array 하나에 layer 별로 그림
+    static ShadowMapUPtr Create(int width, int height, int layers = 1);
     ~ShadowMap();
 
     const uint32_t Get() const { return m_framebuffer; }
     void Bind() const;
+    void BindLayer(int layer) const;
     const TexturePtr GetShadowMap() const { return m_shadowMap; }
+    const Texture2DArrayPtr GetShadowMapArray() const { return m_shadowMapArray; }
+
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    int GetLayerCount() const { return m_layers; }
 
 private:
     ShadowMap() {}
-    bool Init(int width, int height);
+    bool Init(int width, int height, int layers);
 
     uint32_t m_framebuffer { 0 };
     TexturePtr m_shadowMap;
+    Texture2DArrayPtr m_shadowMapArray;
+    int m_width { 0 };
+    int m_height { 0 };
+    int m_layers { 1 };
 };
 
 #endif // __SHADOW_MAP_H__
\ No newline at end of file
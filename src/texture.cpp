@@ -1,4 +1,6 @@
 #include "texture.h"
+#include "mapped_file.h"
+#include "texture_container.h"
 
 TextureUPtr Texture::Create(int width, int height, uint32_t format, uint32_t type) {
     auto texture = TextureUPtr(new Texture());
@@ -15,6 +17,13 @@ TextureUPtr Texture::CreateFromImage(const Image* image) {
     return std::move(texture);
 }
 
+TextureUPtr Texture::CreateFromContainer(const std::string& filepath, bool flipVertical) {
+    auto texture = TextureUPtr(new Texture());
+    if (!texture->LoadContainer(filepath, flipVertical))
+        return nullptr;
+    return std::move(texture);
+}
+
 Texture::~Texture() {
     if (m_texture) {
         glDeleteTextures(1, &m_texture);
@@ -40,6 +49,12 @@ void Texture::SetBorderColor(const glm::vec4& color) const {
     glm::value_ptr(color));
 }
 
+void Texture::SetCompareMode(bool enable) const {
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE,
+        enable ? GL_COMPARE_REF_TO_TEXTURE : GL_NONE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+}
+
 // 이미지 데이터는 복사하지 않고 메모리만 할당
 void Texture::SetTextureFormat(int width, int height, uint32_t format, uint32_t type) {
     m_width = width;
@@ -80,6 +95,84 @@ void Texture::CreateTexture() {
     SetWrap(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
 }
 
+void Texture::SetImage(const Image* image) {
+    Bind();
+    SetTextureFromImage(image);
+}
+
+void Texture::SetImageFromPixelBuffer(int width, int height, int channelCount, const void* offset) {
+    GLenum format = GL_RGBA;
+    switch (channelCount) {
+        default: break;
+        case 1: format = GL_RED; break;
+        case 2: format = GL_RG; break;
+        case 3: format = GL_RGB; break;
+    }
+
+    Bind();
+    // 크기나 format이 같으면 저장 공간을 다시 만들지 않고 내용만 전송
+    if (m_width == width && m_height == height && m_format == format && m_type == GL_UNSIGNED_BYTE) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_width, m_height, format, m_type, offset);
+    }
+    else {
+        m_width = width;
+        m_height = height;
+        m_format = format;
+        m_type = GL_UNSIGNED_BYTE;
+        glTexImage2D(GL_TEXTURE_2D, 0, m_format, m_width, m_height, 0,
+            format, m_type, offset);
+    }
+    glGenerateMipmap(GL_TEXTURE_2D);
+}
+
+bool Texture::LoadContainer(const std::string& filepath, bool flipVertical) {
+    auto file = MappedFile::Open(filepath);
+    if (!file)
+        return false;
+    TextureContainerView view;
+    if (!ParseTextureContainer(file->GetData(), file->GetSize(), view)) {
+        SPDLOG_ERROR("failed to parse texture container: {}", filepath);
+        return false;
+    }
+    if (view.flippedVertically != flipVertical)
+        return false;
+
+    GLenum internalFormat = GL_RGBA8;
+    switch (view.format) {
+        default: break;
+        case TextureContainerFormat::BC1: internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT; break;
+        case TextureContainerFormat::BC3: internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+    }
+    bool compressed = view.format != TextureContainerFormat::RGBA8;
+    if (compressed && !GLAD_GL_EXT_texture_compression_s3tc) {
+        SPDLOG_INFO("s3tc is not supported, skip texture container: {}", filepath);
+        return false;
+    }
+
+    CreateTexture();
+    m_width = (int)view.width;
+    m_height = (int)view.height;
+    m_format = internalFormat;
+    m_type = GL_UNSIGNED_BYTE;
+
+    // map된 파일의 포인터를 그대로 GL에 넘기므로 중간 복사가 없음
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int level = 0; level < (int)view.levels.size(); level++) {
+        const auto& data = view.levels[level];
+        if (compressed) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat,
+                data.width, data.height, 0, (GLsizei)data.size, data.data);
+        }
+        else {
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, data.width, data.height, 0,
+                GL_RGBA, GL_UNSIGNED_BYTE, data.data);
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int)view.levels.size() - 1);
+    return true;
+}
+
 // 이미지 데이터를 복사사
 void Texture::SetTextureFromImage(const Image* image) {
     GLenum format = GL_RGBA;
@@ -118,6 +211,42 @@ void CubeTexture::Bind() const {
     glBindTexture(GL_TEXTURE_CUBE_MAP, m_texture);    
 }
 
+CubeTextureUPtr CubeTexture::Create(int width, int height) {
+    auto texture = CubeTextureUPtr(new CubeTexture());
+    texture->Init(width, height);
+    return std::move(texture);
+}
+
+void CubeTexture::Init(int width, int height) {
+    glGenTextures(1, &m_texture);
+    Bind();
+
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    for (uint32_t i = 0; i < 6; i++) {
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB,
+            width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+    }
+}
+
+void CubeTexture::SetFaceFromPixelBuffer(int face, int width, int height, int channelCount,
+    const void* offset) {
+    GLenum format = GL_RGBA;
+    switch (channelCount) {
+        default: break;
+        case 1: format = GL_RED; break;
+        case 2: format = GL_RG; break;
+        case 3: format = GL_RGB; break;
+    }
+    Bind();
+    glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, 0, 0,
+        width, height, format, GL_UNSIGNED_BYTE, offset);
+}
+
 bool CubeTexture::InitFromImages(const std::vector<Image*>& images) {
     glGenTextures(1, &m_texture);
     Bind();
@@ -145,4 +274,58 @@ bool CubeTexture::InitFromImages(const std::vector<Image*>& images) {
     }
 
     return true;
+}
+
+// texture array 클래스 구현
+Texture2DArrayUPtr Texture2DArray::Create(int width, int height, int layers,
+    uint32_t format, uint32_t type) {
+    auto texture = Texture2DArrayUPtr(new Texture2DArray());
+    texture->Init(width, height, layers, format, type);
+    return std::move(texture);
+}
+
+Texture2DArray::~Texture2DArray() {
+    if (m_texture) {
+        glDeleteTextures(1, &m_texture);
+    }
+}
+
+void Texture2DArray::Bind() const {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture);
+}
+
+void Texture2DArray::SetFilter(uint32_t minFilter, uint32_t magFilter) const {
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, minFilter);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, magFilter);
+}
+
+void Texture2DArray::SetWrap(uint32_t sWrap, uint32_t tWrap) const {
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, sWrap);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, tWrap);
+}
+
+void Texture2DArray::SetBorderColor(const glm::vec4& color) const {
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR,
+        glm::value_ptr(color));
+}
+
+void Texture2DArray::SetCompareMode(bool enable) const {
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE,
+        enable ? GL_COMPARE_REF_TO_TEXTURE : GL_NONE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+}
+
+void Texture2DArray::Init(int width, int height, int layers, uint32_t format, uint32_t type) {
+    m_width = width;
+    m_height = height;
+    m_layers = layers;
+
+    glGenTextures(1, &m_texture);
+    Bind();
+    SetFilter(GL_LINEAR, GL_LINEAR);
+    SetWrap(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+
+    GLenum imageFormat = format == GL_DEPTH_COMPONENT ? GL_DEPTH_COMPONENT : GL_RGBA;
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, format, m_width, m_height, m_layers, 0,
+        imageFormat, type, nullptr);
 }
\ No newline at end of file
@@ -9,13 +9,23 @@ public:
     static TextureUPtr Create(int width, int height,
         uint32_t format, uint32_t type = GL_UNSIGNED_BYTE);
     static TextureUPtr CreateFromImage(const Image* image);
+    // TextureBaker가 만든 .tex 파일을 map해서 복사 없이 그대로 올림 (mip chain 포함)
+    // 파일이 없거나 방향(flipVertical)이 다르거나 압축 형식을 지원하지 않으면 nullptr
+    static TextureUPtr CreateFromContainer(const std::string& filepath, bool flipVertical = true);
     ~Texture();
 
+    // 같은 texture object에 이미지를 다시 올림 (비동기 로딩의 placeholder 교체용)
+    void SetImage(const Image* image);
+    // GL_PIXEL_UNPACK_BUFFER가 bind된 상태에서 호출, offset은 PBO 안에서의 위치
+    void SetImageFromPixelBuffer(int width, int height, int channelCount, const void* offset);
+
     const uint32_t Get() const { return m_texture; }
     void Bind() const;
     void SetFilter(uint32_t minFilter, uint32_t magFilter) const;
     void SetWrap(uint32_t sWrap, uint32_t tWrap) const; // mirror repeat ...
     void SetBorderColor(const glm::vec4& color) const;
+    // depth texture를 sampler2DShadow로 읽을 때 비교 연산 사용
+    void SetCompareMode(bool enable) const;
 
     int GetWidth() const { return m_width; }
     int GetHeight() const { return m_height; }
@@ -27,6 +37,7 @@ private:
     void CreateTexture();
     void SetTextureFromImage(const Image* image);
     void SetTextureFormat(int width, int height, uint32_t format, uint32_t type);
+    bool LoadContainer(const std::string& filepath, bool flipVertical);
 
     uint32_t m_texture { 0 };
     int m_width { 0 };
@@ -39,14 +50,49 @@ CLASS_PTR(CubeTexture)
 class CubeTexture {
 public:
     static CubeTextureUPtr CreateFromImages(const std::vector<Image*>& images);
+    // 면마다 메모리만 할당, 내용은 SetFaceFromPixelBuffer로 채움
+    // PBO가 bind되지 않은 상태에서 호출해야 함
+    static CubeTextureUPtr Create(int width, int height);
     ~CubeTexture();
 
+    void SetFaceFromPixelBuffer(int face, int width, int height, int channelCount, const void* offset);
+
     const uint32_t Get() const { return m_texture; }
     void Bind() const;
 private:
     CubeTexture() {}
     bool InitFromImages(const std::vector<Image*>& images);
+    void Init(int width, int height);
+    uint32_t m_texture { 0 };
+};
+
+// layer 단위로 렌더링 대상이 되는 2D texture array (cascaded shadow map 등)
+CLASS_PTR(Texture2DArray)
+class Texture2DArray {
+public:
+    static Texture2DArrayUPtr Create(int width, int height, int layers,
+        uint32_t format, uint32_t type = GL_UNSIGNED_BYTE);
+    ~Texture2DArray();
+
+    const uint32_t Get() const { return m_texture; }
+    void Bind() const;
+    void SetFilter(uint32_t minFilter, uint32_t magFilter) const;
+    void SetWrap(uint32_t sWrap, uint32_t tWrap) const;
+    void SetBorderColor(const glm::vec4& color) const;
+    void SetCompareMode(bool enable) const;
+
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    int GetLayers() const { return m_layers; }
+
+private:
+    Texture2DArray() {}
+    void Init(int width, int height, int layers, uint32_t format, uint32_t type);
+
     uint32_t m_texture { 0 };
+    int m_width { 0 };
+    int m_height { 0 };
+    int m_layers { 0 };
 };
 
 #endif // __TEXTURE_H__
\ No newline at end of file
@@ -0,0 +1,285 @@
+// 이미지를 mip chain과 block 압축까지 미리 끝낸 texture container(.tex)로 변환하는 도구
+// 사용법: TextureBaker [--format auto|rgba8|bc1|bc3] [--no-flip] <image>...
+// 각 이미지 옆에 <image>.tex 를 만들고, 프로그램은 같은 경로의 .tex가 있으면 그걸 바로 올림
+#include "common.h"
+#include "image.h"
+#include "texture_container.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    // 4x4 block의 RGBA (경계를 넘는 texel은 가장자리 값으로 채움)
+    void FetchBlock(const uint8_t* rgba, int width, int height, int blockX, int blockY, uint8_t block[16][4]) {
+        for (int y = 0; y < 4; y++) {
+            for (int x = 0; x < 4; x++) {
+                int sx = std::min(blockX * 4 + x, width - 1);
+                int sy = std::min(blockY * 4 + y, height - 1);
+                memcpy(block[y * 4 + x], rgba + ((size_t)sy * width + sx) * 4, 4);
+            }
+        }
+    }
+
+    uint16_t PackRGB565(const int color[3]) {
+        int r = (color[0] * 31 + 127) / 255;
+        int g = (color[1] * 63 + 127) / 255;
+        int b = (color[2] * 31 + 127) / 255;
+        return (uint16_t)((r << 11) | (g << 5) | b);
+    }
+
+    void UnpackRGB565(uint16_t packed, int color[3]) {
+        int r = (packed >> 11) & 31;
+        int g = (packed >> 5) & 63;
+        int b = packed & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    // bounding box의 대각선을 endpoint로 쓰되, 색 분포의 기울기에 맞는 대각선을 고름
+    void EncodeColorBlock(const uint8_t block[16][4], uint8_t* out) {
+        int minColor[3] = { 255, 255, 255 };
+        int maxColor[3] = { 0, 0, 0 };
+        int mean[3] = { 0, 0, 0 };
+        for (int i = 0; i < 16; i++) {
+            for (int c = 0; c < 3; c++) {
+                minColor[c] = std::min(minColor[c], (int)block[i][c]);
+                maxColor[c] = std::max(maxColor[c], (int)block[i][c]);
+                mean[c] += block[i][c];
+            }
+        }
+        for (int c = 0; c < 3; c++)
+            mean[c] /= 16;
+
+        // 초록 기준으로 빨강, 파랑이 반대로 움직이면 해당 축의 끝점을 뒤집음
+        int covRG = 0;
+        int covBG = 0;
+        for (int i = 0; i < 16; i++) {
+            int g = block[i][1] - mean[1];
+            covRG += (block[i][0] - mean[0]) * g;
+            covBG += (block[i][2] - mean[2]) * g;
+        }
+        if (covRG < 0)
+            std::swap(minColor[0], maxColor[0]);
+        if (covBG < 0)
+            std::swap(minColor[2], maxColor[2]);
+
+        // 양 끝을 조금 안쪽으로 당겨서 양자화 오차를 줄임
+        for (int c = 0; c < 3; c++) {
+            int inset = (maxColor[c] - minColor[c]) / 16;
+            maxColor[c] -= inset;
+            minColor[c] += inset;
+        }
+
+        uint16_t color0 = PackRGB565(maxColor);
+        uint16_t color1 = PackRGB565(minColor);
+        if (color0 < color1)
+            std::swap(color0, color1);
+
+        uint32_t indices = 0;
+        if (color0 != color1) {
+            int palette[4][3];
+            UnpackRGB565(color0, palette[0]);
+            UnpackRGB565(color1, palette[1]);
+            for (int c = 0; c < 3; c++) {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+            for (int i = 0; i < 16; i++) {
+                int best = 0;
+                int bestDistance = INT32_MAX;
+                for (int p = 0; p < 4; p++) {
+                    int distance = 0;
+                    for (int c = 0; c < 3; c++) {
+                        int d = block[i][c] - palette[p][c];
+                        distance += d * d;
+                    }
+                    if (distance < bestDistance) {
+                        bestDistance = distance;
+                        best = p;
+                    }
+                }
+                indices |= (uint32_t)best << (i * 2);
+            }
+        }
+
+        out[0] = color0 & 0xff;
+        out[1] = color0 >> 8;
+        out[2] = color1 & 0xff;
+        out[3] = color1 >> 8;
+        memcpy(out + 4, &indices, 4);
+    }
+
+    // 8단계 alpha block (alpha0 > alpha1)
+    void EncodeAlphaBlock(const uint8_t block[16][4], uint8_t* out) {
+        int minAlpha = 255;
+        int maxAlpha = 0;
+        for (int i = 0; i < 16; i++) {
+            minAlpha = std::min(minAlpha, (int)block[i][3]);
+            maxAlpha = std::max(maxAlpha, (int)block[i][3]);
+        }
+
+        out[0] = (uint8_t)maxAlpha;
+        out[1] = (uint8_t)minAlpha;
+        uint64_t indices = 0;
+        if (maxAlpha != minAlpha) {
+            int palette[8];
+            palette[0] = maxAlpha;
+            palette[1] = minAlpha;
+            for (int p = 1; p < 7; p++)
+                palette[p + 1] = ((7 - p) * maxAlpha + p * minAlpha) / 7;
+            for (int i = 0; i < 16; i++) {
+                int best = 0;
+                int bestDistance = INT32_MAX;
+                for (int p = 0; p < 8; p++) {
+                    int distance = std::abs(block[i][3] - palette[p]);
+                    if (distance < bestDistance) {
+                        bestDistance = distance;
+                        best = p;
+                    }
+                }
+                indices |= (uint64_t)best << (i * 3);
+            }
+        }
+        for (int i = 0; i < 6; i++)
+            out[2 + i] = (uint8_t)(indices >> (i * 8));
+    }
+
+    std::vector<uint8_t> Compress(TextureContainerFormat format, const uint8_t* rgba, int width, int height) {
+        if (format == TextureContainerFormat::RGBA8)
+            return std::vector<uint8_t>(rgba, rgba + (size_t)width * height * 4);
+
+        int blocksX = (width + 3) / 4;
+        int blocksY = (height + 3) / 4;
+        size_t blockSize = format == TextureContainerFormat::BC1 ? 8 : 16;
+        std::vector<uint8_t> result((size_t)blocksX * blocksY * blockSize);
+        uint8_t block[16][4];
+        for (int by = 0; by < blocksY; by++) {
+            for (int bx = 0; bx < blocksX; bx++) {
+                uint8_t* out = result.data() + ((size_t)by * blocksX + bx) * blockSize;
+                FetchBlock(rgba, width, height, bx, by, block);
+                if (format == TextureContainerFormat::BC3) {
+                    EncodeAlphaBlock(block, out);
+                    out += 8;
+                }
+                EncodeColorBlock(block, out);
+            }
+        }
+        return result;
+    }
+
+    // 2x2 box filter로 절반 크기 mip 생성 (홀수 크기면 마지막 행 / 열을 반복)
+    std::vector<uint8_t> Downsample(const std::vector<uint8_t>& rgba, int width, int height,
+        int& outWidth, int& outHeight) {
+        outWidth = std::max(1, width / 2);
+        outHeight = std::max(1, height / 2);
+        std::vector<uint8_t> result((size_t)outWidth * outHeight * 4);
+        for (int y = 0; y < outHeight; y++) {
+            int y0 = std::min(y * 2, height - 1);
+            int y1 = std::min(y * 2 + 1, height - 1);
+            for (int x = 0; x < outWidth; x++) {
+                int x0 = std::min(x * 2, width - 1);
+                int x1 = std::min(x * 2 + 1, width - 1);
+                for (int c = 0; c < 4; c++) {
+                    int sum = rgba[((size_t)y0 * width + x0) * 4 + c] + rgba[((size_t)y0 * width + x1) * 4 + c] +
+                        rgba[((size_t)y1 * width + x0) * 4 + c] + rgba[((size_t)y1 * width + x1) * 4 + c];
+                    result[((size_t)y * outWidth + x) * 4 + c] = (uint8_t)((sum + 2) / 4);
+                }
+            }
+        }
+        return result;
+    }
+
+    std::vector<uint8_t> ToRGBA(const Image* image) {
+        size_t pixelCount = (size_t)image->GetWidth() * image->GetHeight();
+        int channels = image->GetChannelCount();
+        const uint8_t* data = image->GetData();
+        std::vector<uint8_t> rgba(pixelCount * 4);
+        for (size_t i = 0; i < pixelCount; i++) {
+            const uint8_t* src = data + i * channels;
+            uint8_t* dst = rgba.data() + i * 4;
+            switch (channels) {
+                case 1: dst[0] = dst[1] = dst[2] = src[0]; dst[3] = 255; break;
+                case 2: dst[0] = dst[1] = dst[2] = src[0]; dst[3] = src[1]; break;
+                case 3: dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2]; dst[3] = 255; break;
+                default: memcpy(dst, src, 4); break;
+            }
+        }
+        return rgba;
+    }
+
+    bool Bake(const std::string& inputPath, const std::string& format, bool flipVertical) {
+        auto image = Image::Load(inputPath, flipVertical);
+        if (!image)
+            return false;
+
+        int width = image->GetWidth();
+        int height = image->GetHeight();
+        auto rgba = ToRGBA(image.get());
+
+        TextureContainerFormat containerFormat = TextureContainerFormat::BC1;
+        if (format == "rgba8")
+            containerFormat = TextureContainerFormat::RGBA8;
+        else if (format == "bc3")
+            containerFormat = TextureContainerFormat::BC3;
+        else if (format == "auto") {
+            // 투명한 texel이 하나라도 있으면 alpha를 보존하는 BC3
+            for (size_t i = 3; i < rgba.size(); i += 4) {
+                if (rgba[i] != 255) {
+                    containerFormat = TextureContainerFormat::BC3;
+                    break;
+                }
+            }
+        }
+
+        std::vector<std::vector<uint8_t>> levels;
+        int levelWidth = width;
+        int levelHeight = height;
+        while (true) {
+            levels.push_back(Compress(containerFormat, rgba.data(), levelWidth, levelHeight));
+            if (levelWidth == 1 && levelHeight == 1)
+                break;
+            int nextWidth, nextHeight;
+            rgba = Downsample(rgba, levelWidth, levelHeight, nextWidth, nextHeight);
+            levelWidth = nextWidth;
+            levelHeight = nextHeight;
+        }
+
+        auto outputPath = inputPath + ".tex";
+        if (!WriteTextureContainer(outputPath, containerFormat, width, height, flipVertical, levels))
+            return false;
+
+        size_t totalSize = 0;
+        for (auto& level : levels)
+            totalSize += level.size();
+        SPDLOG_INFO("{} -> {} ({}x{}, {} levels, {} bytes)",
+            inputPath, outputPath, width, height, levels.size(), totalSize);
+        return true;
+    }
+} // namespace
+
+int main(int argc, const char** argv) {
+    std::string format = "auto";
+    bool flipVertical = true;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc)
+            format = argv[++i];
+        else if (arg == "--no-flip")
+            flipVertical = false;
+        else
+            inputs.push_back(arg);
+    }
+
+    if (inputs.empty() || (format != "auto" && format != "rgba8" && format != "bc1" && format != "bc3")) {
+        SPDLOG_ERROR("usage: TextureBaker [--format auto|rgba8|bc1|bc3] [--no-flip] <image>...");
+        return -1;
+    }
+
+    int failed = 0;
+    for (auto& input : inputs) {
+        if (!Bake(input, format, flipVertical))
+            failed++;
+    }
+    return failed == 0 ? 0 : -1;
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "texture_container.h"
+#include <cstring>
+#include <fstream>
+
+namespace {
+    const char kMagic[4] = { 'T', 'G', 'T', 'X' };
+    const uint32_t kVersion = 1;
+    const uint64_t kLevelAlignment = 16;
+}
+
+size_t GetTextureContainerLevelSize(TextureContainerFormat format, uint32_t width, uint32_t height) {
+    size_t blocks = (size_t)((width + 3) / 4) * ((height + 3) / 4);
+    switch (format) {
+        case TextureContainerFormat::BC1: return blocks * 8;
+        case TextureContainerFormat::BC3: return blocks * 16;
+        default: return (size_t)width * height * 4;
+    }
+}
+
+bool ParseTextureContainer(const uint8_t* data, size_t size, TextureContainerView& view) {
+    TextureContainerHeader header;
+    if (!data || size < sizeof(header))
+        return false;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) {
+        SPDLOG_ERROR("not a texture container or unsupported version");
+        return false;
+    }
+    if (header.format > (uint32_t)TextureContainerFormat::BC3 ||
+        header.width == 0 || header.height == 0 || header.levelCount == 0) {
+        SPDLOG_ERROR("invalid texture container header");
+        return false;
+    }
+
+    size_t tableEnd = sizeof(header) + (size_t)header.levelCount * sizeof(TextureContainerLevelEntry);
+    if (tableEnd > size)
+        return false;
+
+    view.format = (TextureContainerFormat)header.format;
+    view.width = header.width;
+    view.height = header.height;
+    view.flippedVertically = (header.flags & kTextureContainerFlippedVertically) != 0;
+    view.levels.clear();
+
+    uint32_t width = header.width;
+    uint32_t height = header.height;
+    for (uint32_t i = 0; i < header.levelCount; i++) {
+        TextureContainerLevelEntry entry;
+        memcpy(&entry, data + sizeof(header) + i * sizeof(entry), sizeof(entry));
+        if (entry.offset > size || entry.size > size - entry.offset ||
+            entry.size != GetTextureContainerLevelSize(view.format, width, height)) {
+            SPDLOG_ERROR("texture container level {} is out of range", i);
+            return false;
+        }
+        view.levels.push_back({ width, height, data + entry.offset, (size_t)entry.size });
+        width = std::max(1u, width / 2);
+        height = std::max(1u, height / 2);
+    }
+    return true;
+}
+
+bool WriteTextureContainer(const std::string& filepath, TextureContainerFormat format,
+    uint32_t width, uint32_t height, bool flippedVertically,
+    const std::vector<std::vector<uint8_t>>& levels) {
+    std::ofstream out(filepath, std::ios::binary);
+    if (!out.is_open()) {
+        SPDLOG_ERROR("failed to open file: {}", filepath);
+        return false;
+    }
+
+    TextureContainerHeader header = {};
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.format = (uint32_t)format;
+    header.width = width;
+    header.height = height;
+    header.levelCount = (uint32_t)levels.size();
+    header.flags = flippedVertically ? kTextureContainerFlippedVertically : 0;
+
+    std::vector<TextureContainerLevelEntry> entries(levels.size());
+    uint64_t offset = sizeof(header) + entries.size() * sizeof(TextureContainerLevelEntry);
+    for (size_t i = 0; i < levels.size(); i++) {
+        offset = (offset + kLevelAlignment - 1) / kLevelAlignment * kLevelAlignment;
+        entries[i].offset = offset;
+        entries[i].size = levels[i].size();
+        offset += levels[i].size();
+    }
+
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)entries.data(), entries.size() * sizeof(TextureContainerLevelEntry));
+    uint64_t written = sizeof(header) + entries.size() * sizeof(TextureContainerLevelEntry);
+    const char padding[kLevelAlignment] = {};
+    for (size_t i = 0; i < levels.size(); i++) {
+        out.write(padding, entries[i].offset - written);
+        out.write((const char*)levels[i].data(), levels[i].size());
+        written = entries[i].offset + levels[i].size();
+    }
+    return out.good();
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#ifndef __TEXTURE_CONTAINER_H__
+#define __TEXTURE_CONTAINER_H__
+
+#include "common.h"
+#include <vector>
+
+/*
+TextureBaker가 만드는 texture 파일 (.tex)
+header | level table (levelCount개) | level 데이터 (16byte 정렬)
+level 0이 원본 크기, 이후로 절반씩 줄어든 mip chain
+*/
+enum class TextureContainerFormat : uint32_t {
+    RGBA8 = 0,
+    BC1 = 1, // RGB, 4x4 block 당 8byte
+    BC3 = 2, // RGBA, 4x4 block 당 16byte
+};
+
+struct TextureContainerHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+struct TextureContainerLevelEntry {
+    uint64_t offset;
+    uint64_t size;
+};
+
+// flags
+const uint32_t kTextureContainerFlippedVertically = 1;
+
+// 파일 내용을 가리키기만 하는 level 정보 (데이터는 복사하지 않음)
+struct TextureContainerLevel {
+    uint32_t width;
+    uint32_t height;
+    const uint8_t* data;
+    size_t size;
+};
+
+struct TextureContainerView {
+    TextureContainerFormat format;
+    uint32_t width;
+    uint32_t height;
+    bool flippedVertically;
+    std::vector<TextureContainerLevel> levels;
+};
+
+size_t GetTextureContainerLevelSize(TextureContainerFormat format, uint32_t width, uint32_t height);
+
+// data가 살아있는 동안만 view가 유효함
+bool ParseTextureContainer(const uint8_t* data, size_t size, TextureContainerView& view);
+
+// levels[i]는 i번째 mip의 데이터
+bool WriteTextureContainer(const std::string& filepath, TextureContainerFormat format,
+    uint32_t width, uint32_t height, bool flippedVertically,
+    const std::vector<std::vector<uint8_t>>& levels);
+
+#endif // __TEXTURE_CONTAINER_H__
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "thread_pool.h"
+
+ThreadPoolUPtr ThreadPool::Create(size_t threadCount) {
+    auto threadPool = ThreadPoolUPtr(new ThreadPool());
+    if (!threadPool->Init(threadCount))
+        return nullptr;
+    return std::move(threadPool);
+}
+
+bool ThreadPool::Init(size_t threadCount) {
+    if (threadCount == 0) {
+        size_t hardwareCount = std::thread::hardware_concurrency();
+        threadCount = hardwareCount > 1 ? hardwareCount - 1 : 1;
+    }
+    try {
+        for (size_t i = 0; i < threadCount; i++)
+            m_threads.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+    catch (const std::system_error& e) {
+        SPDLOG_ERROR("failed to create worker thread: {}", e.what());
+        if (m_threads.empty())
+            return false;
+    }
+    return true;
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+void ThreadPool::Enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push(std::move(task));
+    }
+    m_condition.notify_one();
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t index)>& func) {
+    if (count == 0)
+        return;
+    if (count == 1) {
+        func(0);
+        return;
+    }
+
+    // 늦게 시작한 worker가 접근할 수 있으므로 공유 상태는 shared_ptr로 유지
+    struct State {
+        std::function<void(size_t)> func;
+        size_t count { 0 };
+        std::atomic<size_t> next { 0 };
+        std::atomic<size_t> done { 0 };
+        std::mutex mutex;
+        std::condition_variable condition;
+    };
+    auto state = std::make_shared<State>();
+    state->func = func;
+    state->count = count;
+
+    auto work = [state]() {
+        size_t index;
+        while ((index = state->next++) < state->count) {
+            state->func(index);
+            if (++state->done == state->count) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->condition.notify_all();
+            }
+        }
+    };
+
+    size_t helperCount = std::min(m_threads.size(), count - 1);
+    for (size_t i = 0; i < helperCount; i++)
+        Enqueue(work);
+    work();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->condition.wait(lock, [&state]() { return state->done == state->count; });
+}
+
+void ThreadPool::WorkerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+            if (m_stop)
+                return;
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+        task();
+    }
+}
\ No newline at end of file
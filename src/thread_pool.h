@@ -0,0 +1,40 @@
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include "common.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// 고정된 개수의 worker thread가 FIFO 순서로 작업을 처리
+// 소멸 시 아직 시작하지 않은 작업은 버리고 실행 중인 작업만 기다림
+CLASS_PTR(ThreadPool)
+class ThreadPool {
+public:
+    // threadCount가 0이면 (하드웨어 thread 수 - 1)개, 최소 1개
+    static ThreadPoolUPtr Create(size_t threadCount = 0);
+    ~ThreadPool();
+
+    void Enqueue(std::function<void()> task);
+    // func(0) ~ func(count - 1)을 나눠서 실행하고 모두 끝날 때까지 기다림
+    // 호출한 thread도 같이 일하므로 worker가 모두 바쁘거나 worker 안에서 호출해도 멈추지 않음
+    void ParallelFor(size_t count, const std::function<void(size_t index)>& func);
+    size_t GetThreadCount() const { return m_threads.size(); }
+
+private:
+    ThreadPool() {}
+    bool Init(size_t threadCount);
+    void WorkerLoop();
+
+    std::vector<std::thread> m_threads;
+    std::queue<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stop { false };
+};
+
+#endif // __THREAD_POOL_H__
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "tree_exporter.h"
+
+TreeExporterUPtr TreeExporter::Create(std::shared_ptr<const TreeSnapshot> snapshot, const std::filesystem::path& path,
+    Format format, const Options& options, ThreadPool* pool) {
+    auto exporter = TreeExporterUPtr(new TreeExporter());
+    exporter->m_snapshot = std::move(snapshot);
+    exporter->m_path = path;
+    exporter->m_format = format;
+    exporter->m_options = options;
+    exporter->Start(pool);
+    return std::move(exporter);
+}
+
+TreeExporter::~TreeExporter() {
+    Cancel();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void TreeExporter::Start(ThreadPool* pool) {
+    m_thread = std::thread([this, pool]() {
+        m_succeeded = Export(pool);
+        m_finished = true;
+    });
+}
+
+bool TreeExporter::Export(ThreadPool* pool) {
+    const auto& snapshot = *m_snapshot;
+    switch (m_format) {
+    case Format::Glb:
+        return WriteFile(m_path, true, [&](std::ostream& out) {
+            return snapshot.ExportGlb(out, m_options.glbInstancing, &m_progress);
+        });
+
+    case Format::Tree:
+        return WriteFile(m_path, true, [&](std::ostream& out) {
+            return snapshot.ExportTree(out, m_options.treeBake, &m_progress);
+        });
+
+    default: {
+        // obj 안의 mtllib는 확장자를 뺀 파일 이름을 가리킴
+        std::string name = m_path.stem().string();
+        bool written = WriteFile(m_path, false, [&](std::ostream& out) {
+            return snapshot.ExportObj(out, name, pool, m_options.objDeduplicate, &m_progress);
+        });
+        if (!written)
+            return false;
+        auto mtlPath = m_path;
+        mtlPath.replace_extension(".mtl");
+        if (!WriteFile(mtlPath, false, [&](std::ostream& out) { return snapshot.ExportMtl(out, name); }))
+            return false;
+        return TreeSnapshot::ExportTexture(m_path.parent_path());
+    }
+    }
+}
+
+bool TreeExporter::WriteFile(const std::filesystem::path& path, bool binary,
+    const std::function<bool(std::ostream& out)>& write) {
+    // 취소되면 끝까지 쓴 파일도 버림
+    return WriteFileAtomic(path, binary, [&](std::ostream& out) {
+        return write(out) && !m_progress.canceled;
+    });
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#ifndef __TREE_EXPORTER_H__
+#define __TREE_EXPORTER_H__
+
+#include "common.h"
+#include "tree_snapshot.h"
+#include <filesystem>
+#include <functional>
+#include <thread>
+
+/*
+나무 snapshot 하나를 별도 thread에서 파일로 내보내는 작업
+임시 파일에 다 쓴 뒤 이름을 바꾸므로 취소되거나 실패하면 대상 경로에는 아무것도 남지 않음
+소멸 시 취소를 요청하고 worker가 끝날 때까지 기다림
+*/
+CLASS_PTR(TreeExporter)
+class TreeExporter {
+public:
+    enum class Format {
+        Obj,    // .obj와 같은 이름의 .mtl, 옆에 tree.png
+        Glb,
+        Tree,
+    };
+
+    struct Options {
+        bool objDeduplicate { false };
+        bool glbInstancing { true };
+        bool treeBake { false };
+    };
+
+    // pool은 obj format에 같이 사용 (nullptr이면 exporter thread 혼자 처리)
+    static TreeExporterUPtr Create(std::shared_ptr<const TreeSnapshot> snapshot, const std::filesystem::path& path,
+        Format format, const Options& options, ThreadPool* pool = nullptr);
+    ~TreeExporter();
+
+    const std::filesystem::path& GetPath() const { return m_path; }
+    float GetProgress() const { return m_progress.progress; }
+    bool IsFinished() const { return m_finished; }
+    bool IsCanceled() const { return m_progress.canceled; }
+    void Cancel() { m_progress.canceled = true; }
+    // IsFinished 이후에만 의미 있음
+    bool IsSucceeded() const { return m_finished && m_succeeded; }
+
+private:
+    TreeExporter() {}
+    void Start(ThreadPool* pool);
+    bool Export(ThreadPool* pool);
+    // WriteFileAtomic과 같고 취소되었으면 실패로 처리
+    bool WriteFile(const std::filesystem::path& path, bool binary,
+        const std::function<bool(std::ostream& out)>& write);
+
+    std::shared_ptr<const TreeSnapshot> m_snapshot;
+    std::filesystem::path m_path;
+    Format m_format { Format::Obj };
+    Options m_options;
+    ExportProgress m_progress;
+    std::atomic<bool> m_finished { false };
+    bool m_succeeded { false }; // m_finished가 true가 된 뒤에만 읽음
+    std::thread m_thread;
+};
+
+#endif // __TREE_EXPORTER_H__
\ No newline at end of file
@@ -0,0 +1,349 @@
+#include "tree_file.h"
+#include "vertex_batch.h"
+
+namespace {
+    const uint32_t kMagic = 0x52544754; // "TGTR"
+    const uint32_t kVersion = 1;
+    const uint64_t kDataAlignment = 16;
+    // skeleton 행렬은 마지막 행(0, 0, 0, 1)을 빼고 column 4개의 xyz만 저장
+    const size_t kMatrixFloats = 12;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        TreeFile::Params params;
+        uint32_t cylinderCount;
+        uint32_t leafCount;
+        uint32_t bakedCount;
+        uint32_t reserved;
+        uint64_t stringOffset;
+        uint64_t stringSize;
+        uint64_t skeletonOffset;
+    };
+
+    struct BakedEntry {
+        uint64_t vertexOffset;
+        uint64_t indexOffset;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        float boundsMin[3];
+        float boundsMax[3];
+        float texCoordMin[2];
+        float texCoordMax[2];
+    };
+
+    uint64_t Align(uint64_t offset) {
+        return (offset + kDataAlignment - 1) & ~(kDataAlignment - 1);
+    }
+
+    void AppendString(std::string& block, const std::string& text) {
+        uint32_t length = (uint32_t)text.size();
+        block.append((const char*)&length, sizeof(length));
+        block.append(text);
+    }
+
+    bool ReadString(const uint8_t*& p, const uint8_t* end, std::string& text) {
+        uint32_t length = 0;
+        if ((size_t)(end - p) < sizeof(length))
+            return false;
+        memcpy(&length, p, sizeof(length));
+        p += sizeof(length);
+        if ((size_t)(end - p) < length)
+            return false;
+        text.assign((const char*)p, length);
+        p += length;
+        return true;
+    }
+
+    // 0 ~ 1 범위를 uint16으로
+    uint16_t QuantizeUnorm(float value, float minValue, float maxValue) {
+        float extent = maxValue - minValue;
+        float t = extent > 0.0f ? (value - minValue) / extent : 0.0f;
+        return (uint16_t)std::lround(glm::clamp(t, 0.0f, 1.0f) * 65535.0f);
+    }
+
+    float DequantizeUnorm(uint16_t value, float minValue, float maxValue) {
+        return minValue + (maxValue - minValue) * (value / 65535.0f);
+    }
+
+    // 단위 벡터를 팔면체에 투영해서 -1 ~ 1 범위의 2차원 좌표로
+    glm::vec2 OctahedralEncode(glm::vec3 n) {
+        float sum = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+        if (sum <= 0.0f)
+            return glm::vec2(0.0f);
+        n /= sum;
+        glm::vec2 p(n.x, n.y);
+        if (n.z < 0.0f) {
+            p = glm::vec2(
+                (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+                (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+        }
+        return p;
+    }
+
+    glm::vec3 OctahedralDecode(glm::vec2 p) {
+        glm::vec3 n(p.x, p.y, 1.0f - std::abs(p.x) - std::abs(p.y));
+        if (n.z < 0.0f) {
+            n.x = (1.0f - std::abs(p.y)) * (p.x >= 0.0f ? 1.0f : -1.0f);
+            n.y = (1.0f - std::abs(p.x)) * (p.y >= 0.0f ? 1.0f : -1.0f);
+        }
+        return glm::normalize(n);
+    }
+
+    int16_t QuantizeSnorm(float value) {
+        return (int16_t)std::lround(glm::clamp(value, -1.0f, 1.0f) * 32767.0f);
+    }
+
+    void WriteMatrices(std::ostream& out, const std::vector<glm::mat4>& matrices) {
+        std::vector<float> packed(matrices.size() * kMatrixFloats);
+        for (size_t i = 0; i < matrices.size(); i++) {
+            for (int column = 0; column < 4; column++) {
+                for (int row = 0; row < 3; row++)
+                    packed[i * kMatrixFloats + column * 3 + row] = matrices[i][column][row];
+            }
+        }
+        out.write((const char*)packed.data(), sizeof(float) * packed.size());
+    }
+
+    void ReadMatrices(const uint8_t* data, uint32_t count, std::vector<glm::mat4>& matrices) {
+        matrices.resize(count);
+        float packed[kMatrixFloats];
+        for (uint32_t i = 0; i < count; i++) {
+            memcpy(packed, data + i * sizeof(packed), sizeof(packed));
+            auto& matrix = matrices[i];
+            for (int column = 0; column < 4; column++) {
+                matrix[column] = glm::vec4(packed[column * 3], packed[column * 3 + 1], packed[column * 3 + 2],
+                    column == 3 ? 1.0f : 0.0f);
+            }
+        }
+    }
+
+    // instance마다 변환한 vertex와 section 범위
+    struct BakedMesh {
+        std::vector<TreeFile::PackedVertex> vertices;
+        std::vector<uint32_t> indices;
+        AABB bounds;
+        glm::vec2 texCoordMin { 0.0f };
+        glm::vec2 texCoordMax { 0.0f };
+    };
+
+    bool Bake(const TreeFile::BakeSource& source, BakedMesh& baked) {
+        const auto& vertices = *source.vertices;
+        const auto& indices = *source.indices;
+        const auto& instances = *source.instances;
+        uint64_t vertexCount = (uint64_t)vertices.size() * instances.size();
+        if (vertexCount > UINT32_MAX || (uint64_t)indices.size() * instances.size() > UINT32_MAX) {
+            SPDLOG_ERROR("too many vertices to bake: {}", vertexCount);
+            return false;
+        }
+
+        std::vector<glm::vec3> positions(vertexCount);
+        std::vector<glm::vec3> normals(vertexCount);
+        VertexBatch batch(vertices);
+        for (size_t i = 0; i < instances.size(); i++)
+            batch.Transform(instances[i], positions.data() + i * vertices.size(), normals.data() + i * vertices.size());
+
+        baked.bounds = AABB();
+        for (const auto& position : positions)
+            baked.bounds.Expand(position);
+        if (!vertices.empty()) {
+            baked.texCoordMin = baked.texCoordMax = vertices[0].texCoord;
+            for (const auto& vertex : vertices) {
+                baked.texCoordMin = glm::min(baked.texCoordMin, vertex.texCoord);
+                baked.texCoordMax = glm::max(baked.texCoordMax, vertex.texCoord);
+            }
+        }
+
+        baked.vertices.resize(vertexCount);
+        for (uint64_t i = 0; i < vertexCount; i++) {
+            const auto& vertex = vertices[i % vertices.size()];
+            auto& packed = baked.vertices[i];
+            for (int k = 0; k < 3; k++)
+                packed.position[k] = QuantizeUnorm(positions[i][k], baked.bounds.min[k], baked.bounds.max[k]);
+            glm::vec2 octahedral = OctahedralEncode(normals[i]);
+            packed.normal[0] = QuantizeSnorm(octahedral.x);
+            packed.normal[1] = QuantizeSnorm(octahedral.y);
+            for (int k = 0; k < 2; k++)
+                packed.texCoord[k] = QuantizeUnorm(vertex.texCoord[k], baked.texCoordMin[k], baked.texCoordMax[k]);
+            packed.reserved = 0;
+        }
+
+        baked.indices.resize(indices.size() * instances.size());
+        for (size_t i = 0; i < instances.size(); i++) {
+            uint32_t start = (uint32_t)(i * vertices.size());
+            for (size_t j = 0; j < indices.size(); j++)
+                baked.indices[i * indices.size() + j] = start + indices[j];
+        }
+        return true;
+    }
+}
+
+Vertex TreeFile::BakedMeshView::Decode(uint32_t index) const {
+    const auto& packed = vertices[index];
+    Vertex vertex;
+    for (int k = 0; k < 3; k++)
+        vertex.position[k] = DequantizeUnorm(packed.position[k], bounds.min[k], bounds.max[k]);
+    vertex.normal = OctahedralDecode(glm::vec2(packed.normal[0] / 32767.0f, packed.normal[1] / 32767.0f));
+    for (int k = 0; k < 2; k++)
+        vertex.texCoord[k] = DequantizeUnorm(packed.texCoord[k], texCoordMin[k], texCoordMax[k]);
+    vertex.tangent = glm::vec3(0.0f);
+    return vertex;
+}
+
+TreeFileUPtr TreeFile::Open(const std::string& filename) {
+    auto file = TreeFileUPtr(new TreeFile());
+    if (!file->Load(filename))
+        return nullptr;
+    return std::move(file);
+}
+
+/*
+파일 구성
+Header, BakedEntry * bakedCount
+string block: axiom, rules, codes, 각각 uint32 길이 + 문자열
+skeleton: 가지 행렬 * cylinderCount, 잎 행렬 * leafCount (행렬마다 float 12개)
+baked mesh마다 PackedVertex 배열, uint32 index 배열
+*/
+bool TreeFile::Load(const std::string& filename) {
+    m_file = MappedFile::Open(filename);
+    if (!m_file)
+        return false;
+    const uint8_t* data = m_file->GetData();
+    uint64_t size = m_file->GetSize();
+
+    Header header;
+    if (size < sizeof(Header)) {
+        SPDLOG_ERROR("invalid tree file: {}", filename);
+        return false;
+    }
+    memcpy(&header, data, sizeof(Header));
+    uint64_t skeletonSize = ((uint64_t)header.cylinderCount + header.leafCount) * kMatrixFloats * sizeof(float);
+    if (header.magic != kMagic || header.version != kVersion ||
+        (uint64_t)header.bakedCount * sizeof(BakedEntry) > size - sizeof(Header) ||
+        header.stringOffset > size || header.stringSize > size - header.stringOffset ||
+        header.skeletonOffset % kDataAlignment ||
+        header.skeletonOffset > size || skeletonSize > size - header.skeletonOffset) {
+        SPDLOG_ERROR("invalid tree file: {}", filename);
+        return false;
+    }
+    m_params = header.params;
+
+    const uint8_t* p = data + header.stringOffset;
+    const uint8_t* stringEnd = p + header.stringSize;
+    if (!ReadString(p, stringEnd, m_axiom) ||
+        !ReadString(p, stringEnd, m_rules) ||
+        !ReadString(p, stringEnd, m_codes)) {
+        SPDLOG_ERROR("invalid tree file: {}", filename);
+        return false;
+    }
+
+    const uint8_t* skeleton = data + header.skeletonOffset;
+    ReadMatrices(skeleton, header.cylinderCount, m_cylinders);
+    ReadMatrices(skeleton + (uint64_t)header.cylinderCount * kMatrixFloats * sizeof(float),
+        header.leafCount, m_leaves);
+
+    const BakedEntry* entries = (const BakedEntry*)(data + sizeof(Header));
+    m_baked.resize(header.bakedCount);
+    for (uint32_t i = 0; i < header.bakedCount; i++) {
+        BakedEntry entry;
+        memcpy(&entry, &entries[i], sizeof(BakedEntry));
+        uint64_t vertexBytes = (uint64_t)entry.vertexCount * sizeof(PackedVertex);
+        uint64_t indexBytes = (uint64_t)entry.indexCount * sizeof(uint32_t);
+        if (entry.vertexOffset % kDataAlignment || entry.indexOffset % kDataAlignment ||
+            entry.vertexOffset > size || vertexBytes > size - entry.vertexOffset ||
+            entry.indexOffset > size || indexBytes > size - entry.indexOffset) {
+            SPDLOG_ERROR("invalid tree file: {}", filename);
+            return false;
+        }
+
+        auto& baked = m_baked[i];
+        baked.vertices = (const PackedVertex*)(data + entry.vertexOffset);
+        baked.vertexCount = entry.vertexCount;
+        baked.indices = (const uint32_t*)(data + entry.indexOffset);
+        baked.indexCount = entry.indexCount;
+        baked.bounds.min = glm::vec3(entry.boundsMin[0], entry.boundsMin[1], entry.boundsMin[2]);
+        baked.bounds.max = glm::vec3(entry.boundsMax[0], entry.boundsMax[1], entry.boundsMax[2]);
+        baked.texCoordMin = glm::vec2(entry.texCoordMin[0], entry.texCoordMin[1]);
+        baked.texCoordMax = glm::vec2(entry.texCoordMax[0], entry.texCoordMax[1]);
+    }
+    return true;
+}
+
+bool TreeFile::Write(std::ostream& out, const Source& source) {
+    // header의 개수는 32bit
+    if (source.cylinders->size() > UINT32_MAX || source.leaves->size() > UINT32_MAX) {
+        SPDLOG_ERROR("Too many instances to save : {}, {}", source.cylinders->size(), source.leaves->size());
+        return false;
+    }
+
+    std::vector<BakedMesh> baked(source.baked.size());
+    for (size_t i = 0; i < baked.size(); i++) {
+        if (!Bake(source.baked[i], baked[i]))
+            return false;
+    }
+
+    std::string strings;
+    AppendString(strings, source.axiom);
+    AppendString(strings, source.rules);
+    AppendString(strings, source.codes);
+
+    Header header = {};
+    header.magic = kMagic;
+    header.version = kVersion;
+    header.params = source.params;
+    header.cylinderCount = (uint32_t)source.cylinders->size();
+    header.leafCount = (uint32_t)source.leaves->size();
+    header.bakedCount = (uint32_t)baked.size();
+    header.stringOffset = sizeof(Header) + sizeof(BakedEntry) * baked.size();
+    header.stringSize = strings.size();
+    header.skeletonOffset = Align(header.stringOffset + header.stringSize);
+
+    std::vector<BakedEntry> entries(baked.size());
+    uint64_t skeletonSize = ((uint64_t)header.cylinderCount + header.leafCount) * kMatrixFloats * sizeof(float);
+    uint64_t offset = Align(header.skeletonOffset + skeletonSize);
+    for (size_t i = 0; i < baked.size(); i++) {
+        auto& mesh = baked[i];
+        auto& entry = entries[i];
+        entry = {};
+        entry.vertexCount = (uint32_t)mesh.vertices.size();
+        entry.indexCount = (uint32_t)mesh.indices.size();
+        for (int k = 0; k < 3; k++) {
+            entry.boundsMin[k] = mesh.bounds.min[k];
+            entry.boundsMax[k] = mesh.bounds.max[k];
+        }
+        for (int k = 0; k < 2; k++) {
+            entry.texCoordMin[k] = mesh.texCoordMin[k];
+            entry.texCoordMax[k] = mesh.texCoordMax[k];
+        }
+        entry.vertexOffset = offset;
+        offset = Align(offset + mesh.vertices.size() * sizeof(PackedVertex));
+        entry.indexOffset = offset;
+        offset = Align(offset + mesh.indices.size() * sizeof(uint32_t));
+    }
+
+    const char padding[kDataAlignment] = {};
+    uint64_t position = 0;
+    auto Write = [&out, &position](const void* data, uint64_t size) {
+        out.write((const char*)data, size);
+        position += size;
+    };
+    auto Pad = [&Write, &padding, &position]() {
+        Write(padding, Align(position) - position);
+    };
+
+    Write(&header, sizeof(header));
+    Write(entries.data(), sizeof(BakedEntry) * entries.size());
+    Write(strings.data(), strings.size());
+    Pad();
+    WriteMatrices(out, *source.cylinders);
+    WriteMatrices(out, *source.leaves);
+    position += skeletonSize;
+    Pad();
+    for (auto& mesh : baked) {
+        Write(mesh.vertices.data(), sizeof(PackedVertex) * mesh.vertices.size());
+        Pad();
+        Write(mesh.indices.data(), sizeof(uint32_t) * mesh.indices.size());
+        Pad();
+    }
+    return (bool)out;
+}
\ No newline at end of file
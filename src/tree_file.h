@@ -0,0 +1,99 @@
+#ifndef __TREE_FILE_H__
+#define __TREE_FILE_H__
+
+#include "common.h"
+#include "mapped_file.h"
+#include "mesh.h"
+#include <ostream>
+#include <vector>
+
+/*
+나무를 다시 만드는 데 필요한 것을 그대로 저장하는 binary 파일 (.tree)
+문법(axiom, rules), seed, 인자, 치환이 끝난 codes, 가지 / 잎 행렬(skeleton)을 저장하므로
+읽을 때 문자열 parse나 행렬 계산 없이 바로 instance를 배치할 수 있음
+선택적으로 변환이 끝난 가지 geometry(baked)도 저장, 읽을 때 LSystem이 가지 mesh로 그대로 올림
+  position: section bounds 기준 uint16 3개, normal: octahedral snorm16 2개, texCoord: section 범위 기준 uint16 2개
+파일을 map해서 읽으므로 모든 배열은 16byte 정렬
+*/
+CLASS_PTR(TreeFile)
+class TreeFile {
+public:
+    // 파일에 그대로 저장되는 인자 (LSystem::Create와 같은 의미)
+    struct Params {
+        float cylinderRadius;
+        float cylinderHeight;
+        float leafRadius;
+        float leafHeight;
+        float radiusScaling;
+        float heightScaling;
+        float angle;
+        int32_t iteration;
+        uint32_t seed;
+        uint32_t sphere;
+        float xCoord;
+        float zCoord;
+    };
+
+    struct PackedVertex {
+        uint16_t position[3];
+        int16_t normal[2];
+        uint16_t texCoord[2];
+        uint16_t reserved;
+    };
+
+    // 저장할 geometry, instances마다 vertices를 변환해서 하나로 합침
+    struct BakeSource {
+        const std::vector<Vertex>* vertices;
+        const std::vector<uint32_t>* indices;
+        const std::vector<glm::mat4>* instances;
+    };
+
+    struct Source {
+        Params params;
+        std::string axiom;
+        std::string rules;
+        std::string codes;
+        const std::vector<glm::mat4>* cylinders;
+        const std::vector<glm::mat4>* leaves;
+        std::vector<BakeSource> baked; // 비어 있으면 skeleton만 저장
+    };
+
+    // map된 파일 안을 가리키므로 TreeFile이 살아있는 동안만 유효
+    struct BakedMeshView {
+        const PackedVertex* vertices { nullptr };
+        uint32_t vertexCount { 0 };
+        const uint32_t* indices { nullptr };
+        uint32_t indexCount { 0 };
+        AABB bounds;
+        glm::vec2 texCoordMin { 0.0f };
+        glm::vec2 texCoordMax { 0.0f };
+
+        Vertex Decode(uint32_t index) const;
+    };
+
+    static TreeFileUPtr Open(const std::string& filename);
+    static bool Write(std::ostream& out, const Source& source);
+
+    const Params& GetParams() const { return m_params; }
+    const std::string& GetAxiom() const { return m_axiom; }
+    const std::string& GetRules() const { return m_rules; }
+    const std::string& GetCodes() const { return m_codes; }
+    const std::vector<glm::mat4>& GetCylinders() const { return m_cylinders; }
+    const std::vector<glm::mat4>& GetLeaves() const { return m_leaves; }
+    const std::vector<BakedMeshView>& GetBakedMeshes() const { return m_baked; }
+
+private:
+    TreeFile() {}
+    bool Load(const std::string& filename);
+
+    MappedFileUPtr m_file;
+    Params m_params;
+    std::string m_axiom;
+    std::string m_rules;
+    std::string m_codes;
+    std::vector<glm::mat4> m_cylinders;
+    std::vector<glm::mat4> m_leaves;
+    std::vector<BakedMeshView> m_baked;
+};
+
+#endif // __TREE_FILE_H__
\ No newline at end of file
@@ -0,0 +1,295 @@
+#include "tree_snapshot.h"
+#include "obj_writer.h"
+#include "glb_writer.h"
+#include "vertex_batch.h"
+#include <unordered_map>
+
+bool TreeSnapshot::ExportObj(std::ostream& out, const std::string& material, ThreadPool* pool,
+    bool deduplicate, ExportProgress* progress) const {
+    if (!out) {
+        SPDLOG_ERROR("Failed to open obj file");
+        return false;
+    }
+
+    ObjWriter writer(out);
+    writer.Write("# tree generator\n\n");
+    writer.Write("# material\n");
+    writer.Write("mtllib ./" + material + ".mtl\n");
+
+    // deduplicate일 때 vn은 kNormalScale 단위로 양자화해서 파일 전체에서 한 번씩만 씀
+    // 단위 구 위의 격자점은 천만 개 정도라 번호는 uint32로 충분
+    const float kNormalScale = 1000.0f;
+    std::unordered_map<uint64_t, uint32_t> normalIds;
+    // n은 VertexBatch가 정규화한 normal
+    auto QuantizeNormal = [kNormalScale](const glm::vec3& n) {
+        // 각 성분을 0 ~ 2000으로 옮겨 21bit씩 묶음 (11bit 세 개는 uint32에 들어가지 않음)
+        auto Component = [kNormalScale](float value) {
+            return (uint64_t)std::lround(glm::clamp(value, -1.0f, 1.0f) * kNormalScale + kNormalScale);
+        };
+        return (Component(n.x) << 42) | (Component(n.y) << 21) | Component(n.z);
+    };
+    auto DequantizeNormal = [kNormalScale](uint64_t key) {
+        auto Component = [kNormalScale](uint64_t value) {
+            return ((float)(value & 0x1fffff) - kNormalScale) / kNormalScale;
+        };
+        return glm::vec3(Component(key >> 42), Component(key >> 21), Component(key));
+    };
+
+    // 진행률은 instance를 순회하는 section만 세고, 취소되면 남은 chunk는 format하지 않음
+    uint64_t totalInstances = (uint64_t)(cylinderInstances.size() + leaves.size()) * (deduplicate ? 2 : 4);
+    std::atomic<uint64_t> doneInstances { 0 };
+    auto Canceled = [progress]() {
+        return progress && progress->canceled;
+    };
+    auto WriteInstances = [&](size_t count, size_t instancesPerChunk, const ObjWriter::ChunkFormatter& format) {
+        writer.WriteChunks(pool, count, instancesPerChunk, [&](ObjWriter& chunk, size_t first, size_t last) {
+            if (Canceled())
+                return;
+            format(chunk, first, last);
+            if (progress)
+                progress->progress = (float)(doneInstances += last - first) / totalInstances;
+        });
+    };
+
+    // instance마다 mesh를 변환해서 v, vt, vn, f 순서로 씀, 중간 배열 없이 section마다 instance를 다시 순회
+    // instance끼리는 독립적이고 면 번호도 instance 번호로 바로 정해지므로 chunk로 나눠 pool에서 동시에 format
+    // offset은 이 section 앞에 쓴 v, vt, vn 개수, 이 section에서 쓴 개수를 돌려줌
+    auto WriteObject = [&](const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+        const std::vector<glm::mat4>& matrices, ObjWriter::FaceVertex offset) {
+        uint64_t stride = vertices.size();
+        VertexBatch batch(vertices);
+        // chunk 하나에 vertex 64K개 정도
+        size_t instancesPerChunk = std::max<size_t>(1, (1 << 16) / std::max<size_t>(1, vertices.size()));
+
+        writer.Write("# vertex coordinates\n");
+        WriteInstances(matrices.size(), instancesPerChunk,
+            [&](ObjWriter& chunk, size_t first, size_t last) {
+            std::vector<glm::vec3> positions(vertices.size());
+            for (size_t i = first; i < last; i++) {
+                batch.Transform(matrices[i], positions.data(), nullptr);
+                for (const auto& position : positions)
+                    chunk.WritePosition(position);
+            }
+        });
+
+        if (!deduplicate) {
+            writer.Write("\n# texture coordinates\n");
+            WriteInstances(matrices.size(), instancesPerChunk,
+                [&](ObjWriter& chunk, size_t first, size_t last) {
+                for (size_t i = first; i < last; i++) {
+                    for (const auto& vertex : vertices)
+                        chunk.WriteTexCoord(vertex.texCoord);
+                }
+            });
+
+            writer.Write("\n# normal coordinates\n");
+            WriteInstances(matrices.size(), instancesPerChunk,
+                [&](ObjWriter& chunk, size_t first, size_t last) {
+                std::vector<glm::vec3> normals(vertices.size());
+                for (size_t i = first; i < last; i++) {
+                    batch.Transform(matrices[i], nullptr, normals.data());
+                    for (const auto& normal : normals)
+                        chunk.WriteNormal(normal);
+                }
+            });
+
+            writer.Write("\n# face\n");
+            writer.Write("usemtl Tree\n");
+            WriteInstances(matrices.size(), instancesPerChunk,
+                [&](ObjWriter& chunk, size_t first, size_t last) {
+                for (size_t i = first; i < last; i++) {
+                    uint64_t start = offset.position + stride * i + 1;
+                    for (size_t j = 0; j + 2 < indices.size(); j += 3)
+                        chunk.WriteFace(indices[j] + start, indices[j+1] + start, indices[j+2] + start);
+                }
+            });
+            return ObjWriter::FaceVertex { stride * matrices.size(), stride * matrices.size(), stride * matrices.size() };
+        }
+
+        // texture 좌표는 instance와 관계없으므로 template mesh의 것을 한 번만 씀
+        writer.Write("\n# texture coordinates\n");
+        for (const auto& vertex : vertices)
+            writer.WriteTexCoord(vertex.texCoord);
+
+        // 양자화는 instance chunk마다 동시에, 번호 매기기는 파일 순서를 지키기 위해 순서대로
+        std::vector<uint64_t> normals(matrices.size() * vertices.size());
+        size_t chunkCount = (matrices.size() + instancesPerChunk - 1) / instancesPerChunk;
+        auto QuantizeChunk = [&](size_t index) {
+            std::vector<glm::vec3> transformed(vertices.size());
+            size_t last = std::min(matrices.size(), (index + 1) * instancesPerChunk);
+            for (size_t i = index * instancesPerChunk; i < last; i++) {
+                batch.Transform(matrices[i], nullptr, transformed.data());
+                uint64_t* keys = normals.data() + i * vertices.size();
+                for (size_t j = 0; j < vertices.size(); j++)
+                    keys[j] = QuantizeNormal(transformed[j]);
+            }
+        };
+        if (Canceled())
+            return offset;
+        if (pool)
+            pool->ParallelFor(chunkCount, QuantizeChunk);
+        else
+            for (size_t i = 0; i < chunkCount; i++)
+                QuantizeChunk(i);
+
+        std::vector<uint64_t> newNormals;
+        for (auto& normal : normals) {
+            auto result = normalIds.emplace(normal, (uint32_t)normalIds.size());
+            if (result.second)
+                newNormals.push_back(normal);
+            normal = result.first->second;
+        }
+
+        writer.Write("\n# normal coordinates\n");
+        writer.WriteChunks(pool, newNormals.size(), 1 << 16,
+            [&](ObjWriter& chunk, size_t first, size_t last) {
+            if (Canceled())
+                return;
+            for (size_t i = first; i < last; i++)
+                chunk.WriteNormal(DequantizeNormal(newNormals[i]));
+        });
+
+        writer.Write("\n# face\n");
+        writer.Write("usemtl Tree\n");
+        WriteInstances(matrices.size(), instancesPerChunk,
+            [&](ObjWriter& chunk, size_t first, size_t last) {
+            for (size_t i = first; i < last; i++) {
+                uint64_t start = offset.position + stride * i + 1;
+                const uint64_t* ids = normals.data() + i * vertices.size(); // 파일 전체 기준 vn 번호
+                auto Corner = [&](uint32_t index) {
+                    return ObjWriter::FaceVertex { index + start, index + offset.texCoord + 1, ids[index] + 1 };
+                };
+                for (size_t j = 0; j + 2 < indices.size(); j += 3)
+                    chunk.WriteFace(Corner(indices[j]), Corner(indices[j+1]), Corner(indices[j+2]));
+            }
+        });
+        return ObjWriter::FaceVertex { stride * matrices.size(), vertices.size(), newNormals.size() };
+    };
+
+    writer.Write("o Cylinder\n");
+    auto cylinderCount = WriteObject(cylinderVertices, cylinderIndices, cylinderInstances, ObjWriter::FaceVertex { 0, 0, 0 });
+
+    writer.Write("\no Leaf\n");
+    WriteObject(leafVertices, leafIndices, leaves, cylinderCount);
+
+    if (Canceled())
+        return false;
+    if (!writer.Flush()) {
+        SPDLOG_ERROR("Failed to write obj");
+        return false;
+    }
+    return true;
+}
+
+bool TreeSnapshot::ExportGlb(std::ostream& out, bool instancing, ExportProgress* progress) const {
+    if (!out) {
+        SPDLOG_ERROR("Failed to open glb file");
+        return false;
+    }
+
+    auto writer = GlbWriter::Create(instancing);
+    // 화면에서처럼 가지와 납작한 잎은 tree.png의 alpha로 잘라냄 (leaf.fs의 discard 기준과 같음)
+    int treeTexture = writer->AddImage("./image/tree.png");
+    int treeMaterial = writer->AddMaterial("Tree", treeTexture, glm::vec4(1.0f), 0.05f, true);
+
+    writer->AddMesh("Cylinder", cylinderVertices, cylinderIndices, treeMaterial, cylinderInstances);
+    if (progress) {
+        if (progress->canceled)
+            return false;
+        progress->progress = 0.4f;
+    }
+    if (params.sphere) {
+        int greenMaterial = writer->AddMaterial("Green", -1, glm::vec4(0.27f, 0.334f, 0.118f, 1.0f));
+        writer->AddMesh("Leaf", leafVertices, leafIndices, greenMaterial, leaves);
+    }
+    else {
+        writer->AddMesh("Leaf", leafVertices, leafIndices, treeMaterial, leaves);
+    }
+    if (progress) {
+        if (progress->canceled)
+            return false;
+        progress->progress = 0.8f;
+    }
+
+    const auto& stats = writer->GetStats();
+    SPDLOG_INFO("glb export: {} instanced, {} baked", stats.instancedCount, stats.bakedCount);
+    if (!writer->Write(out)) {
+        SPDLOG_ERROR("Failed to write glb");
+        return false;
+    }
+    return true;
+}
+
+bool TreeSnapshot::ExportTree(std::ostream& out, bool bakeGeometry, ExportProgress* progress) const {
+    if (!out) {
+        SPDLOG_ERROR("Failed to open tree file");
+        return false;
+    }
+
+    TreeFile::Source source;
+    source.params = params;
+    source.axiom = axiom;
+    source.rules = rules;
+    source.codes = codes;
+    source.cylinders = &cylinders;
+    source.leaves = &leaves;
+    // 가지 geometry만 저장, 잎은 culling을 위해 어차피 instance로 그리므로 skeleton으로 충분
+    // 합친 가지 mesh가 없으면 원기둥 instance를 변환해서 저장
+    std::vector<glm::mat4> identity { glm::mat4(1.0f) };
+    if (bakeGeometry && !branchVertices.empty())
+        source.baked.push_back({ &branchVertices, &branchIndices, &identity });
+    else if (bakeGeometry)
+        source.baked.push_back({ &cylinderVertices, &cylinderIndices, &cylinderInstances });
+    if (progress && progress->canceled)
+        return false;
+
+    if (!TreeFile::Write(out, source)) {
+        SPDLOG_ERROR("Failed to write tree");
+        return false;
+    }
+    return true;
+}
+
+bool TreeSnapshot::ExportMtl(std::ostream& out, const std::string& texture) {
+    if (!out) {
+        SPDLOG_ERROR("Failed to open mtl file");
+        return false;
+    }
+
+    out << "# Dice.mtl\n\n";
+
+    out << "newmtl Tree\n\n";
+
+    out << "# ambient color\n";
+    out << "Ka 0.2 0.2 0.2\n\n";
+
+    out << "# diffuse color\n";
+    out << "Kd 0.7 0.7 0.7\n\n";
+
+    out << "# specular color\n";
+    out << "Ka 0.7 0.7 0.7\n\n";
+
+    out << "# Blinn-Phong shading\n";
+    out << "illum 2\n\n";
+
+    out << "# texture\n";
+    // out << "map_Kd ./" + texture + ".png\n";
+    out << "map_Kd ./tree.png\n";
+
+    return true;
+}
+
+// 다시 encode할 필요가 없으므로 원본 파일을 그대로 복사
+bool TreeSnapshot::ExportTexture(const std::filesystem::path& dir) {
+    const std::filesystem::path source = "./image/tree.png";
+    auto target = dir / "tree.png";
+    std::error_code error;
+    if (std::filesystem::equivalent(source, target, error))
+        return true;
+    std::filesystem::copy_file(source, target, std::filesystem::copy_options::overwrite_existing, error);
+    if (error) {
+        SPDLOG_ERROR("Failed to copy texture to : {} ({})", dir.string(), error.message());
+        return false;
+    }
+    return true;
+}
\ No newline at end of file
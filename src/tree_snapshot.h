@@ -0,0 +1,57 @@
+#ifndef __TREE_SNAPSHOT_H__
+#define __TREE_SNAPSHOT_H__
+
+#include "common.h"
+#include "mesh.h"
+#include "thread_pool.h"
+#include "tree_file.h"
+#include <atomic>
+#include <ostream>
+#include <vector>
+
+// 다른 thread에서 진행률을 읽고 취소를 요청할 수 있도록 exporter에 넘기는 상태
+struct ExportProgress {
+    std::atomic<float> progress { 0.0f }; // 0 ~ 1
+    std::atomic<bool> canceled { false };
+};
+
+/*
+파일로 내보낼 때 필요한 나무 데이터의 복사본
+LSystem::GetSnapshot으로 만든 뒤에는 바뀌지 않으므로 저장 thread에서 읽는 동안 원래 나무를 고치거나 새로 만들어도 됨
+GL 객체는 들고 있지 않고 가지, 잎 mesh의 CPU 쪽 배열만 복사
+progress가 있으면 진행률을 갱신하고 취소되면 false
+*/
+CLASS_PTR(TreeSnapshot)
+class TreeSnapshot {
+public:
+    TreeFile::Params params;
+    std::string axiom;
+    std::string rules;
+    std::string codes;
+    std::vector<glm::mat4> cylinders;           // 가지 skeleton 행렬
+    std::vector<glm::mat4> cylinderInstances;   // 원기둥 mesh 원점 보정까지 적용된 instance 행렬
+    std::vector<glm::mat4> leaves;
+    std::vector<Vertex> cylinderVertices;
+    std::vector<uint32_t> cylinderIndices;
+    std::vector<Vertex> leafVertices;           // params.sphere면 구 mesh
+    std::vector<uint32_t> leafIndices;
+    std::vector<Vertex> branchVertices;         // 화면에 그리는 합친 가지 mesh (world space), 만들지 않았으면 비어 있음
+    std::vector<uint32_t> branchIndices;
+
+    bool IsEmpty() const { return codes.empty(); }
+
+    // pool이 있으면 instance를 나눠서 동시에 format (출력은 순서대로 쓴 것과 같음)
+    // deduplicate면 vt는 mesh 종류마다 한 번, vn은 양자화해서 같은 값을 한 번만 쓰고 면은 v/vt/vn 번호를 따로 씀
+    bool ExportObj(std::ostream& out, const std::string& material, ThreadPool* pool = nullptr,
+        bool deduplicate = false, ExportProgress* progress = nullptr) const;
+    static bool ExportMtl(std::ostream& out, const std::string& texture);
+    // 가지, 잎 mesh는 한 번만 저장하고 instance는 EXT_mesh_gpu_instancing으로 배치
+    // instancing이 false면 모든 instance를 변환해서 합친 mesh로 저장
+    bool ExportGlb(std::ostream& out, bool instancing = true, ExportProgress* progress = nullptr) const;
+    // out은 binary로 열어야 함, bakeGeometry면 변환한 가지, 잎 geometry도 양자화해서 저장
+    bool ExportTree(std::ostream& out, bool bakeGeometry = false, ExportProgress* progress = nullptr) const;
+    // mtl의 map_Kd가 가리키는 tree.png를 dir에 복사
+    static bool ExportTexture(const std::filesystem::path& dir);
+};
+
+#endif // __TREE_SNAPSHOT_H__
\ No newline at end of file
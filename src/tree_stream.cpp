@@ -0,0 +1,233 @@
+#include "tree_stream.h"
+#include "bounded_queue.h"
+#include "derivation.h"
+#include "obj_writer.h"
+#include "turtle.h"
+#include "vertex_batch.h"
+#include <random>
+#include <thread>
+
+namespace {
+    // turtle 단계가 만든 instance 행렬 묶음
+    struct InstanceBatch {
+        std::vector<glm::mat4> cylinders; // 원기둥 mesh 원점 보정까지 적용된 행렬
+        std::vector<glm::mat4> leaves;
+    };
+
+    struct Template {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+    };
+
+    const size_t kSymbolsPerChunk = 1 << 16;
+    const size_t kInstancesPerBatch = 1024;
+    // obj 한 줄의 크기를 넉넉하게 잡은 값 (f 줄 기준), format 중인 chunk 크기를 계산할 때 사용
+    const size_t kBytesPerLine = 128;
+
+    bool WriteStream(const TreeStream::Options& options, std::ostream& out, const std::string& material,
+        ThreadPool* pool, ExportProgress* progress, TreeStream::Stats& stats) {
+        const auto& params = options.params;
+        size_t budget = std::max(options.memoryBudget, TreeStream::kMinMemoryBudget);
+        auto Canceled = [progress]() {
+            return progress && progress->canceled;
+        };
+
+        Template cylinder;
+        Template leaf;
+        Mesh::GenerateCylinder(cylinder.vertices, cylinder.indices, params.cylinderRadius, params.cylinderHeight, params.radiusScaling);
+        if (params.sphere)
+            Mesh::GenerateSphere(leaf.vertices, leaf.indices, params.leafRadius);
+        else
+            Mesh::GenerateLeaf(leaf.vertices, leaf.indices, params.leafRadius, params.leafHeight);
+        VertexBatch cylinderBatch(cylinder.vertices);
+        VertexBatch leafBatch(leaf.vertices);
+
+        // 예산 배분: 글자 queue 1/16, instance queue 1/4, 동시에 format 중인 obj chunk 1/2, 출력 버퍼 1/16
+        // 나머지는 turtle의 '[' stack, derivation frame처럼 나무 크기가 아닌 괄호 깊이, iteration에 비례하는 것들
+        size_t symbolCapacity = std::max<size_t>(2, budget / 16 / kSymbolsPerChunk);
+        // batch 하나는 가지, 잎 배열을 따로 들고 있으므로 최대 두 배까지 잡음
+        size_t batchCapacity = std::max<size_t>(2, budget / 4 / (kInstancesPerBatch * sizeof(glm::mat4) * 2));
+        size_t waveSize = pool ? (pool->GetThreadCount() + 1) * 2 : 1;
+        auto InstancesPerChunk = [&](const Template& mesh) {
+            size_t lines = std::max<size_t>(1, std::max(mesh.vertices.size(), mesh.indices.size() / 3));
+            size_t byBudget = budget / 2 / (waveSize * lines * kBytesPerLine);
+            // ExportObj처럼 chunk 하나에 vertex 64K개 정도까지
+            size_t bySize = (1 << 16) / std::max<size_t>(1, mesh.vertices.size());
+            return std::max<size_t>(1, std::min(byBudget, bySize));
+        };
+        size_t cylindersPerChunk = InstancesPerChunk(cylinder);
+        size_t leavesPerChunk = InstancesPerChunk(leaf);
+
+        BoundedQueue<std::string> symbolQueue(symbolCapacity);
+        BoundedQueue<InstanceBatch> batchQueue(batchCapacity);
+        std::atomic<uint64_t> symbolCount { 0 };
+
+        // derivation: 최종 문자열을 앞에서부터 chunk 단위로 펼침
+        std::thread deriver([&]() {
+            Derivation derivation(options.axiom, options.rules, params.iteration, params.seed);
+            while (!Canceled()) {
+                std::string chunk(kSymbolsPerChunk, '\0');
+                chunk.resize(derivation.Read(chunk.data(), chunk.size()));
+                if (chunk.empty())
+                    break;
+                symbolCount += chunk.size();
+                if (!symbolQueue.Push(std::move(chunk)))
+                    break;
+            }
+            symbolQueue.Close();
+        });
+
+        // turtle: 글자를 해석해서 instance 행렬을 batch로 묶음
+        std::thread interpreter([&]() {
+            Turtle turtle({ params.cylinderHeight, params.radiusScaling, params.heightScaling, params.angle, params.seed,
+                params.xCoord, params.zCoord });
+            auto cylinderOffset = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.0f * params.cylinderHeight, 0.0f));
+            InstanceBatch batch;
+            std::string chunk;
+            glm::mat4 matrix;
+            bool open = true;
+            while (open && symbolQueue.Pop(chunk)) {
+                for (char symbol : chunk) {
+                    switch (turtle.Step(symbol, matrix)) {
+                    case Turtle::Output::Branch:
+                        batch.cylinders.push_back(matrix * cylinderOffset);
+                        break;
+                    case Turtle::Output::Leaf:
+                        batch.leaves.push_back(matrix);
+                        break;
+                    default:
+                        break;
+                    }
+                    if (batch.cylinders.size() + batch.leaves.size() >= kInstancesPerBatch) {
+                        open = batchQueue.Push(std::move(batch));
+                        batch = InstanceBatch();
+                        if (!open)
+                            break;
+                    }
+                }
+            }
+            if (open && (!batch.cylinders.empty() || !batch.leaves.empty()))
+                batchQueue.Push(std::move(batch));
+            // 뒤 단계가 먼저 멈췄으면 derivation도 멈춤
+            symbolQueue.Close();
+            batchQueue.Close();
+        });
+
+        // 출력: batch마다 v, vt, vn, f를 이어서 씀, 면 번호는 파일 처음부터 센 vertex 번호
+        ObjWriter writer(out, std::min<size_t>(1 << 20, budget / 16));
+        writer.Write("# tree generator\n\n");
+        writer.Write("# material\n");
+        writer.Write("mtllib ./" + material + ".mtl\n");
+
+        uint64_t written = 0; // 앞에서 쓴 v 개수 (vt, vn도 같은 개수)
+        auto WriteInstances = [&](const char* group, const Template& mesh, const VertexBatch& vertexBatch,
+            size_t instancesPerChunk, const std::vector<glm::mat4>& matrices) {
+            if (matrices.empty())
+                return;
+            uint64_t stride = mesh.vertices.size();
+            writer.Write(std::string("g ") + group + "\n");
+            writer.WriteChunks(pool, matrices.size(), instancesPerChunk,
+                [&](ObjWriter& chunk, size_t first, size_t last) {
+                std::vector<glm::vec3> positions(mesh.vertices.size());
+                for (size_t i = first; i < last; i++) {
+                    vertexBatch.Transform(matrices[i], positions.data(), nullptr);
+                    for (const auto& position : positions)
+                        chunk.WritePosition(position);
+                }
+            });
+            writer.WriteChunks(pool, matrices.size(), instancesPerChunk,
+                [&](ObjWriter& chunk, size_t first, size_t last) {
+                for (size_t i = first; i < last; i++) {
+                    for (const auto& vertex : mesh.vertices)
+                        chunk.WriteTexCoord(vertex.texCoord);
+                }
+            });
+            writer.WriteChunks(pool, matrices.size(), instancesPerChunk,
+                [&](ObjWriter& chunk, size_t first, size_t last) {
+                std::vector<glm::vec3> normals(mesh.vertices.size());
+                for (size_t i = first; i < last; i++) {
+                    vertexBatch.Transform(matrices[i], nullptr, normals.data());
+                    for (const auto& normal : normals)
+                        chunk.WriteNormal(normal);
+                }
+            });
+            writer.Write("usemtl Tree\n");
+            writer.WriteChunks(pool, matrices.size(), instancesPerChunk,
+                [&](ObjWriter& chunk, size_t first, size_t last) {
+                for (size_t i = first; i < last; i++) {
+                    uint64_t start = written + stride * i + 1;
+                    const auto& indices = mesh.indices;
+                    for (size_t j = 0; j + 2 < indices.size(); j += 3)
+                        chunk.WriteFace(indices[j] + start, indices[j+1] + start, indices[j+2] + start);
+                }
+            });
+            written += stride * matrices.size();
+        };
+
+        bool succeeded = true;
+        InstanceBatch batch;
+        while (batchQueue.Pop(batch)) {
+            if (Canceled() || !writer.IsGood()) {
+                succeeded = false;
+                break;
+            }
+            WriteInstances("Cylinder", cylinder, cylinderBatch, cylindersPerChunk, batch.cylinders);
+            WriteInstances("Leaf", leaf, leafBatch, leavesPerChunk, batch.leaves);
+            stats.cylinders += batch.cylinders.size();
+            stats.leaves += batch.leaves.size();
+        }
+
+        // 실패하거나 취소되면 앞 단계들이 queue에서 기다리지 않도록 닫음
+        batchQueue.Close();
+        symbolQueue.Close();
+        deriver.join();
+        interpreter.join();
+        stats.symbols = symbolCount;
+        stats.vertices = written;
+
+        if (!succeeded || Canceled())
+            return false;
+        if (!writer.Flush()) {
+            SPDLOG_ERROR("Failed to write obj");
+            return false;
+        }
+        return true;
+    }
+}
+
+bool TreeStream::ExportObj(const Options& options, const std::filesystem::path& path, ThreadPool* pool,
+    ExportProgress* progress, Stats* stats) {
+    if (options.params.radiusScaling <= 0.0f || options.params.heightScaling <= 0.0f) {
+        SPDLOG_ERROR("Invalid tree scaling : {}, {}", options.params.radiusScaling, options.params.heightScaling);
+        return false;
+    }
+
+    // LSystem과 같이 seed가 0이면 임의로 정함
+    Options resolved = options;
+    if (resolved.params.seed == 0) {
+        std::random_device rd;
+        while (resolved.params.seed == 0)
+            resolved.params.seed = rd();
+    }
+
+    std::string name = path.stem().string();
+    Stats result;
+    bool written = WriteFileAtomic(path, false, [&](std::ostream& out) {
+        return WriteStream(resolved, out, name, pool, progress, result);
+    });
+    if (stats)
+        *stats = result;
+    if (!written)
+        return false;
+
+    auto mtlPath = path;
+    mtlPath.replace_extension(".mtl");
+    if (!WriteFileAtomic(mtlPath, false, [&](std::ostream& out) { return TreeSnapshot::ExportMtl(out, name); }))
+        return false;
+    if (!TreeSnapshot::ExportTexture(path.parent_path()))
+        return false;
+
+    SPDLOG_INFO("stream export: {} (seed {}, {} symbols, {} cylinders, {} leaves, {} vertices)",
+        path.string(), resolved.params.seed, result.symbols, result.cylinders, result.leaves, result.vertices);
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef __TREE_STREAM_H__
+#define __TREE_STREAM_H__
+
+#include "common.h"
+#include "thread_pool.h"
+#include "tree_file.h"
+#include "tree_snapshot.h"
+#include <filesystem>
+#include <string>
+
+/*
+문자열, 행렬 목록, 변환한 geometry를 메모리에 모으지 않고 obj로 바로 내보내는 streaming export
+derivation -> turtle -> obj 출력을 각각의 thread에서 돌리고 크기가 정해진 queue로 이어서
+나무 크기와 관계없이 memoryBudget 안에서 만든 순서대로 파일에 씀
+화면의 나무와 달리 codes, 행렬을 남기지 않으므로 창 없이 아주 큰 나무를 내보낼 때 사용
+*/
+class TreeStream {
+public:
+    struct Options {
+        TreeFile::Params params;
+        std::string axiom;
+        std::string rules;
+        size_t memoryBudget { (size_t)256 << 20 }; // byte, 너무 작으면 kMinMemoryBudget으로 올림
+    };
+
+    struct Stats {
+        uint64_t symbols { 0 };
+        uint64_t cylinders { 0 };
+        uint64_t leaves { 0 };
+        uint64_t vertices { 0 };
+    };
+
+    static constexpr size_t kMinMemoryBudget = (size_t)16 << 20;
+
+    // path에 obj, 같은 이름의 mtl을 쓰고 tree.png를 옆에 복사, 임시 파일에 다 쓴 뒤 이름을 바꿈
+    // pool이 있으면 obj format을 나눠서 처리, progress는 취소 여부만 확인 (전체 크기를 미리 알 수 없음)
+    static bool ExportObj(const Options& options, const std::filesystem::path& path, ThreadPool* pool = nullptr,
+        ExportProgress* progress = nullptr, Stats* stats = nullptr);
+};
+
+#endif // __TREE_STREAM_H__
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "turtle.h"
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+Turtle::Turtle(const Params& params)
+    : m_params(params), m_gen(params.seed), m_normalDistEnd(0.0f, 0.5f), m_normalDistAngle(params.angle, 4.0f) {
+    m_state.matrix = glm::translate(glm::mat4(1.0f), glm::vec3(params.xCoord, 0.0f, params.zCoord));
+    m_state.scaling = glm::mat4(1.0f);
+}
+
+// 회전 후 이동 -> 이동행렬 * 회전행렬 (순서)
+Turtle::Output Turtle::Step(char symbol, glm::mat4& matrix) {
+    const float weight = 1.5f;
+    const float height = m_params.cylinderHeight;
+    char previous = m_previous;
+    m_previous = symbol;
+
+    // 어떤 글자든 각도는 하나씩 뽑음
+    float randomAngle = m_normalDistAngle(m_gen);
+    float offset = weight * sin(randomAngle * M_PI / 180.0f) * (height / 2.0f);
+    auto Rotate = [](float degree, const glm::vec3& axis) {
+        return glm::rotate(glm::mat4(1.0f), glm::radians(degree), axis);
+    };
+    auto Translate = [](const glm::vec3& position) {
+        return glm::translate(glm::mat4(1.0f), position);
+    };
+
+    if (IsBranch(symbol)) {
+        m_state.matrix = m_state.matrix * (glm::scale(glm::mat4(1.0f), glm::vec3(m_params.radiusScaling, m_params.heightScaling, m_params.radiusScaling)) *
+            Translate(glm::vec3(0.0f, height * (m_params.heightScaling + 1.0f) / 2.2f, 0.0f)));
+        // 역행렬이 무조건 존재한다고 가정
+        m_state.scaling = m_state.scaling * glm::scale(glm::mat4(1.0f), glm::vec3(1.0f / m_params.radiusScaling,
+            1.0f / m_params.heightScaling, 1.0f / m_params.radiusScaling));
+        matrix = m_state.matrix;
+        return Output::Branch;
+    }
+
+    switch (symbol) {
+    case '+':
+        m_state.matrix = m_state.matrix * Rotate(randomAngle, glm::vec3(0.0f, 1.0f, 0.0f));
+        break;
+
+    case '-':
+        m_state.matrix = m_state.matrix * Rotate(-randomAngle, glm::vec3(0.0f, 1.0f, 0.0f));
+        break;
+
+    case '^':
+        m_state.matrix = m_state.matrix * (Rotate(randomAngle, glm::vec3(1.0f, 0.0f, 0.0f)) * Translate(glm::vec3(0.0f, 0.0f, offset)));
+        break;
+
+    case '&':
+        m_state.matrix = m_state.matrix * (Rotate(-randomAngle, glm::vec3(1.0f, 0.0f, 0.0f)) * Translate(glm::vec3(0.0f, 0.0f, -offset)));
+        break;
+
+    case '<':
+        m_state.matrix = m_state.matrix * (Rotate(randomAngle, glm::vec3(0.0f, 0.0f, 1.0f)) * Translate(glm::vec3(-offset, 0.0f, 0.0f)));
+        break;
+
+    case '>':
+        m_state.matrix = m_state.matrix * (Rotate(-randomAngle, glm::vec3(0.0f, 0.0f, 1.0f)) * Translate(glm::vec3(offset, 0.0f, 0.0f)));
+        break;
+
+    case '|':
+        m_state.matrix = m_state.matrix * Rotate(180.0f, glm::vec3(0.0f, 1.0f, 0.0f));
+        break;
+
+    case '[':
+        m_saved.push_back(m_state);
+        break;
+
+    case ']': {
+        int randomNum = static_cast<int>(floor(m_normalDistEnd(m_gen)));
+        bool leaf = (IsBranch(previous) && randomNum == 0) || randomNum == -1;
+        if (leaf)
+            matrix = m_state.matrix * Translate(glm::vec3(0.0f, height / -2.0f, 0.0f)) * m_state.scaling;
+
+        // 짝이 없는 ']'는 상태를 되돌리지 않음
+        if (!m_saved.empty()) {
+            m_state = m_saved.back();
+            m_saved.pop_back();
+        }
+        return leaf ? Output::Leaf : Output::None;
+    }
+    }
+    return Output::None;
+}
\ No newline at end of file
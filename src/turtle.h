@@ -0,0 +1,58 @@
+#ifndef __TURTLE_H__
+#define __TURTLE_H__
+
+#include "common.h"
+#include <random>
+#include <vector>
+
+/*
+L-System 문자열을 한 글자씩 받아 가지, 잎 행렬을 만드는 turtle
+문자열 전체를 들고 있지 않아도 되므로 LSystem과 streaming export가 같이 사용
+행렬 stack은 '['에서 저장한 상태만 들고 있어 메모리는 괄호 깊이에만 비례
+난수는 글자마다 같은 순서로 뽑으므로 seed와 문자열이 같으면 결과도 같음
+*/
+class Turtle {
+public:
+    struct Params {
+        float cylinderHeight;
+        float radiusScaling;
+        float heightScaling;
+        float angle;
+        uint32_t seed;
+        float xCoord;
+        float zCoord;
+    };
+
+    enum class Output {
+        None,
+        Branch, // 가지 skeleton 행렬 (원기둥 mesh 원점 보정 전)
+        Leaf,
+    };
+
+    explicit Turtle(const Params& params);
+
+    // symbol 하나를 해석, 행렬이 생기면 matrix에 쓰고 그 종류를 돌려줌
+    Output Step(char symbol, glm::mat4& matrix);
+
+    // 가지 하나를 만드는 "이동" 글자인지
+    static bool IsBranch(char symbol) {
+        return symbol == 'F' || symbol == 'X' || symbol == 'A' || symbol == 'C';
+    }
+
+private:
+    struct State {
+        glm::mat4 matrix;
+        glm::mat4 scaling; // 나뭇잎 크기 계산을 위함
+    };
+
+    Params m_params;
+    State m_state;
+    std::vector<State> m_saved; // '['마다 하나
+    char m_previous { 0 };
+
+    std::mt19937 m_gen;
+    std::normal_distribution<float> m_normalDistEnd;
+    std::normal_distribution<float> m_normalDistAngle;
+};
+
+#endif // __TURTLE_H__
\ No newline at end of file
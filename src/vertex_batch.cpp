@@ -0,0 +1,277 @@
+#include "vertex_batch.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define VERTEX_BATCH_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+namespace {
+    const size_t kLanes = 8;
+
+    // 행렬은 column 순서로 펼쳐서 넘김
+    struct KernelArgs {
+        const float* position[3];
+        const float* normal[3];
+        size_t count;
+        float matrix[12];       // mat4의 xyz 행, column 4개
+        float normalMatrix[9];  // mat3, column 3개
+        glm::vec3* outPositions;
+        glm::vec3* outNormals;
+    };
+
+    using Kernel = void (*)(const KernelArgs& args);
+
+    // lane별로 계산한 x, y, z를 vec3 배열에 나눠 씀
+    inline void Scatter(const float* x, const float* y, const float* z, size_t count, glm::vec3* out) {
+        for (size_t k = 0; k < count; k++) {
+            out[k].x = x[k];
+            out[k].y = y[k];
+            out[k].z = z[k];
+        }
+    }
+
+#ifndef VERTEX_BATCH_X86
+    void TransformScalar(const KernelArgs& args) {
+        const float* m = args.matrix;
+        const float* n = args.normalMatrix;
+        for (size_t i = 0; i < args.count; i++) {
+            if (args.outPositions) {
+                float x = args.position[0][i], y = args.position[1][i], z = args.position[2][i];
+                args.outPositions[i] = glm::vec3(
+                    m[0] * x + m[3] * y + m[6] * z + m[9],
+                    m[1] * x + m[4] * y + m[7] * z + m[10],
+                    m[2] * x + m[5] * y + m[8] * z + m[11]);
+            }
+            if (args.outNormals) {
+                float x = args.normal[0][i], y = args.normal[1][i], z = args.normal[2][i];
+                float nx = n[0] * x + n[3] * y + n[6] * z;
+                float ny = n[1] * x + n[4] * y + n[7] * z;
+                float nz = n[2] * x + n[5] * y + n[8] * z;
+                float length = std::sqrt(nx * nx + ny * ny + nz * nz);
+                float scale = length > 0.0f ? 1.0f / length : 0.0f;
+                args.outNormals[i] = glm::vec3(nx * scale, ny * scale, nz * scale);
+            }
+        }
+    }
+#else
+    static_assert(sizeof(glm::vec3) == sizeof(float) * 3, "glm::vec3 must be tightly packed");
+
+    // x0..x3, y0..y3, z0..z3을 x0 y0 z0 x1 ... z3 순서로 한 번에 씀
+    inline void StoreInterleaved(__m128 x, __m128 y, __m128 z, glm::vec3* out) {
+        __m128 xy = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0)); // x0 x2 y0 y2
+        __m128 yz = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1)); // y1 y3 z1 z3
+        __m128 zx = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0)); // z0 z2 x1 x3
+        float* p = &out->x;
+        _mm_storeu_ps(p, _mm_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0)));     // x0 y0 z0 x1
+        _mm_storeu_ps(p + 4, _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0))); // y1 z1 x2 y2
+        _mm_storeu_ps(p + 8, _mm_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1))); // z2 x3 y3 z3
+    }
+
+    // SSE2는 x86-64에서 항상 있으므로 CPU 확인 없이 사용
+    void TransformSse(const KernelArgs& args) {
+        // 마지막 block만 lane 수가 모자람
+        auto Store = [](const __m128* value, size_t lanes, glm::vec3* out) {
+            if (lanes == 4) {
+                StoreInterleaved(value[0], value[1], value[2], out);
+                return;
+            }
+            alignas(16) float result[3][4];
+            for (int row = 0; row < 3; row++)
+                _mm_store_ps(result[row], value[row]);
+            Scatter(result[0], result[1], result[2], lanes, out);
+        };
+        const float* m = args.matrix;
+        const float* n = args.normalMatrix;
+        for (size_t i = 0; i < args.count; i += 4) {
+            size_t lanes = std::min<size_t>(4, args.count - i);
+            if (args.outPositions) {
+                __m128 x = _mm_loadu_ps(args.position[0] + i);
+                __m128 y = _mm_loadu_ps(args.position[1] + i);
+                __m128 z = _mm_loadu_ps(args.position[2] + i);
+                __m128 value[3];
+                for (int row = 0; row < 3; row++) {
+                    value[row] = _mm_add_ps(
+                        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[row]), x), _mm_mul_ps(_mm_set1_ps(m[3 + row]), y)),
+                        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[6 + row]), z), _mm_set1_ps(m[9 + row])));
+                }
+                Store(value, lanes, args.outPositions + i);
+            }
+            if (args.outNormals) {
+                __m128 x = _mm_loadu_ps(args.normal[0] + i);
+                __m128 y = _mm_loadu_ps(args.normal[1] + i);
+                __m128 z = _mm_loadu_ps(args.normal[2] + i);
+                __m128 value[3];
+                for (int row = 0; row < 3; row++) {
+                    value[row] = _mm_add_ps(
+                        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(n[row]), x), _mm_mul_ps(_mm_set1_ps(n[3 + row]), y)),
+                        _mm_mul_ps(_mm_set1_ps(n[6 + row]), z));
+                }
+                __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(value[0], value[0]),
+                    _mm_mul_ps(value[1], value[1])), _mm_mul_ps(value[2], value[2]));
+                __m128 length = _mm_sqrt_ps(lengthSquared);
+                // 길이가 0이면 0 벡터로 둠
+                __m128 scale = _mm_and_ps(_mm_div_ps(_mm_set1_ps(1.0f), length),
+                    _mm_cmpgt_ps(length, _mm_setzero_ps()));
+                for (int row = 0; row < 3; row++)
+                    value[row] = _mm_mul_ps(value[row], scale);
+                Store(value, lanes, args.outNormals + i);
+            }
+        }
+    }
+
+    // StoreInterleaved의 8 lane 판, 128bit 절반마다 같은 shuffle 후 절반끼리 다시 섞음
+    TARGET_AVX2 inline void StoreInterleaved(__m256 x, __m256 y, __m256 z, glm::vec3* out) {
+        __m256 xy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 yz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+        __m256 zx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+        __m256 r03 = _mm256_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0)); // x0 y0 z0 x1 | x4 y4 z4 x5
+        __m256 r14 = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0)); // y1 z1 x2 y2 | y5 z5 x6 y6
+        __m256 r25 = _mm256_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1)); // z2 x3 y3 z3 | z6 x7 y7 z7
+        float* p = &out->x;
+        _mm256_storeu_ps(p, _mm256_permute2f128_ps(r03, r14, 0x20));
+        _mm256_storeu_ps(p + 8, _mm256_permute2f128_ps(r25, r03, 0x30));
+        _mm256_storeu_ps(p + 16, _mm256_permute2f128_ps(r14, r25, 0x31));
+    }
+
+    TARGET_AVX2 void TransformAvx2(const KernelArgs& args) {
+        auto Store = [](const __m256* value, size_t lanes, glm::vec3* out) TARGET_AVX2 {
+            if (lanes == kLanes) {
+                StoreInterleaved(value[0], value[1], value[2], out);
+                return;
+            }
+            alignas(32) float result[3][kLanes];
+            for (int row = 0; row < 3; row++)
+                _mm256_store_ps(result[row], value[row]);
+            Scatter(result[0], result[1], result[2], lanes, out);
+        };
+        const float* m = args.matrix;
+        const float* n = args.normalMatrix;
+        for (size_t i = 0; i < args.count; i += kLanes) {
+            size_t lanes = std::min(kLanes, args.count - i);
+            if (args.outPositions) {
+                __m256 x = _mm256_loadu_ps(args.position[0] + i);
+                __m256 y = _mm256_loadu_ps(args.position[1] + i);
+                __m256 z = _mm256_loadu_ps(args.position[2] + i);
+                __m256 value[3];
+                for (int row = 0; row < 3; row++) {
+                    value[row] = _mm256_fmadd_ps(_mm256_set1_ps(m[row]), x, _mm256_set1_ps(m[9 + row]));
+                    value[row] = _mm256_fmadd_ps(_mm256_set1_ps(m[3 + row]), y, value[row]);
+                    value[row] = _mm256_fmadd_ps(_mm256_set1_ps(m[6 + row]), z, value[row]);
+                }
+                Store(value, lanes, args.outPositions + i);
+            }
+            if (args.outNormals) {
+                __m256 x = _mm256_loadu_ps(args.normal[0] + i);
+                __m256 y = _mm256_loadu_ps(args.normal[1] + i);
+                __m256 z = _mm256_loadu_ps(args.normal[2] + i);
+                __m256 value[3];
+                for (int row = 0; row < 3; row++) {
+                    value[row] = _mm256_mul_ps(_mm256_set1_ps(n[row]), x);
+                    value[row] = _mm256_fmadd_ps(_mm256_set1_ps(n[3 + row]), y, value[row]);
+                    value[row] = _mm256_fmadd_ps(_mm256_set1_ps(n[6 + row]), z, value[row]);
+                }
+                __m256 lengthSquared = _mm256_mul_ps(value[0], value[0]);
+                lengthSquared = _mm256_fmadd_ps(value[1], value[1], lengthSquared);
+                lengthSquared = _mm256_fmadd_ps(value[2], value[2], lengthSquared);
+                __m256 length = _mm256_sqrt_ps(lengthSquared);
+                __m256 scale = _mm256_and_ps(_mm256_div_ps(_mm256_set1_ps(1.0f), length),
+                    _mm256_cmp_ps(length, _mm256_setzero_ps(), _CMP_GT_OQ));
+                for (int row = 0; row < 3; row++)
+                    value[row] = _mm256_mul_ps(value[row], scale);
+                Store(value, lanes, args.outNormals + i);
+            }
+        }
+    }
+
+    bool HasAvx2() {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+        __cpuid(info, 1);
+        bool fma = (info[2] & (1 << 12)) != 0;
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        __cpuidex(info, 7, 0);
+        bool avx2 = (info[1] & (1 << 5)) != 0;
+        // OS가 YMM register를 저장해주는지 확인
+        return fma && osxsave && avx && avx2 && (_xgetbv(0) & 6) == 6;
+#else
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+    }
+#endif
+
+    struct KernelChoice {
+        Kernel kernel;
+        const char* name;
+    };
+
+    const KernelChoice& GetKernel() {
+        static const KernelChoice choice = []() -> KernelChoice {
+#ifdef VERTEX_BATCH_X86
+            if (HasAvx2())
+                return { TransformAvx2, "avx2" };
+            return { TransformSse, "sse" };
+#else
+            return { TransformScalar, "scalar" };
+#endif
+        }();
+        return choice;
+    }
+}
+
+VertexBatch::VertexBatch(const std::vector<Vertex>& vertices) {
+    m_count = vertices.size();
+    m_stride = (m_count + kLanes - 1) / kLanes * kLanes;
+    // 남는 칸은 0으로 두고 결과에서 버림
+    m_data.assign(m_stride * 6, 0.0f);
+    for (size_t i = 0; i < m_count; i++) {
+        for (int k = 0; k < 3; k++) {
+            m_data[m_stride * k + i] = vertices[i].position[k];
+            m_data[m_stride * (3 + k) + i] = vertices[i].normal[k];
+        }
+    }
+}
+
+void VertexBatch::Transform(const glm::mat4& matrix, glm::vec3* outPositions, glm::vec3* outNormals) const {
+    if (m_count == 0 || (!outPositions && !outNormals))
+        return;
+
+    KernelArgs args;
+    for (int k = 0; k < 3; k++) {
+        args.position[k] = m_data.data() + m_stride * k;
+        args.normal[k] = m_data.data() + m_stride * (3 + k);
+    }
+    args.count = m_count;
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 3; row++)
+            args.matrix[column * 3 + row] = matrix[column][row];
+    }
+    if (outNormals) {
+        glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(matrix)));
+        for (int column = 0; column < 3; column++) {
+            for (int row = 0; row < 3; row++)
+                args.normalMatrix[column * 3 + row] = normalMatrix[column][row];
+        }
+    }
+    else {
+        std::fill(std::begin(args.normalMatrix), std::end(args.normalMatrix), 0.0f);
+    }
+    args.outPositions = outPositions;
+    args.outNormals = outNormals;
+    GetKernel().kernel(args);
+}
+
+const char* VertexBatch::GetKernelName() {
+    return GetKernel().name;
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#ifndef __VERTEX_BATCH_H__
+#define __VERTEX_BATCH_H__
+
+#include "common.h"
+#include "mesh.h"
+#include <vector>
+
+/*
+template mesh의 position, normal을 SoA로 모아두고 instance 행렬로 한 번에 변환하는 kernel
+AVX2(FMA) / SSE / scalar 구현 중 CPU가 지원하는 것을 처음 사용할 때 한 번 고름
+normal은 행렬의 inverse transpose로 변환한 뒤 정규화 (scale이 축마다 달라도 면에 수직)
+export, mesh baking에서 같이 사용
+*/
+class VertexBatch {
+public:
+    explicit VertexBatch(const std::vector<Vertex>& vertices);
+
+    size_t GetCount() const { return m_count; }
+    // outPositions, outNormals에 GetCount()개씩 씀, nullptr이면 그 항목은 건너뜀
+    void Transform(const glm::mat4& matrix, glm::vec3* outPositions, glm::vec3* outNormals) const;
+
+    // 선택된 구현 이름 ("avx2", "sse", "scalar")
+    static const char* GetKernelName();
+
+private:
+    size_t m_count { 0 };
+    size_t m_stride { 0 }; // 8의 배수로 올린 개수
+    // px, py, pz, nx, ny, nz 순서로 m_stride개씩
+    std::vector<float> m_data;
+};
+
+#endif // __VERTEX_BATCH_H__
\ No newline at end of file
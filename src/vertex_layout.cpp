@@ -24,6 +24,10 @@ void VertexLayout::SetAttrib(uint32_t attribIndex, int count,
     glVertexAttribPointer(attribIndex, count, type, normalized, stride, (const void*)offset);
 }
 
+void VertexLayout::SetAttribDivisor(uint32_t attribIndex, uint32_t divisor) const {
+    glVertexAttribDivisor(attribIndex, divisor);
+}
+
 void VertexLayout::Init() {
     glGenVertexArrays(1, &m_vertexArrayObject);
     Bind();
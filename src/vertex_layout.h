@@ -21,6 +21,8 @@ public:
                     uint32_t type, bool normalized,
                     size_t stride, uint64_t offset) const;
     void DisableAttrib(int attribIndex) const;
+    // instancing: divisor 만큼의 인스턴스마다 attribute 값을 한 칸씩 진행
+    void SetAttribDivisor(uint32_t attribIndex, uint32_t divisor) const;
 
 private:
     VertexLayout() {}